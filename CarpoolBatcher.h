@@ -0,0 +1,183 @@
+#ifndef CARPOOL_BATCHER_H
+#define CARPOOL_BATCHER_H
+
+#include "User.h"
+#include "RideTypes.h"
+#include "GeoUtils.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
+
+struct CarpoolBatchConfig {
+    std::chrono::milliseconds window{2000}; // how long requests are collected before a solve
+    double maxPickupSpreadKm = 1.5;         // max distance between pickups in one group
+    double maxDropoffSpreadKm = 2.0;        // max distance between dropoffs in one group
+    int headingBuckets = 8;                 // members must travel in the same heading sector
+    int maxGroupSeats = 4;                  // total party size of one group
+};
+
+struct PendingCarpoolRequest {
+    std::string rideId;
+    GeoPoint pickup;
+    GeoPoint dropoff;
+    VehicleType vehicleType;
+    int passengerCount;
+    std::chrono::steady_clock::time_point requestedAt;
+};
+
+// Indexes into a batch of requests that should share one vehicle
+struct CarpoolCluster {
+    VehicleType vehicleType;
+    std::vector<std::size_t> members;
+    int seats; // sum of the members' party sizes
+};
+
+// Collects CARPOOL requests on a worker thread and hands each window's batch,
+// already clustered by origin/destination similarity and request time, to a
+// solver callback. Submitting never waits for a solve in progress.
+class CarpoolBatcher {
+public:
+    using Solver = std::function<void(const std::vector<PendingCarpoolRequest>&,
+                                      const std::vector<CarpoolCluster>&)>;
+
+private:
+    CarpoolBatchConfig config;
+    Solver solver;
+    std::vector<PendingCarpoolRequest> pending;
+    std::mutex pendingMutex;
+    std::mutex solveMutex; // one solve at a time (worker or flush)
+    std::condition_variable wakeUp;
+    std::thread worker;
+    bool running = false;
+
+    void solveBatch(const std::vector<PendingCarpoolRequest>& batch) {
+        if (batch.empty()) {
+            return;
+        }
+        std::vector<CarpoolCluster> clusters = formClusters(batch, config);
+        solver(batch, clusters);
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(pendingMutex);
+        while (running) {
+            wakeUp.wait_for(lock, config.window, [this]() { return !running; });
+
+            std::vector<PendingCarpoolRequest> batch;
+            batch.swap(pending);
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> solveLock(solveMutex);
+                solveBatch(batch);
+            }
+            lock.lock();
+        }
+    }
+
+public:
+    ~CarpoolBatcher() { stop(); }
+
+    void start(const CarpoolBatchConfig& batchConfig, Solver batchSolver) {
+        stop();
+        config = batchConfig;
+        solver = std::move(batchSolver);
+        running = true;
+        worker = std::thread(&CarpoolBatcher::workerLoop, this);
+    }
+
+    // Stops the worker after it has solved whatever was still pending
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            if (!running) {
+                return;
+            }
+            running = false;
+        }
+        wakeUp.notify_all();
+        worker.join();
+    }
+
+    bool isRunning() {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        return running;
+    }
+
+    void submit(const PendingCarpoolRequest& request) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending.push_back(request);
+    }
+
+    // Solves the current batch on the calling thread without waiting for the window
+    void flush() {
+        std::vector<PendingCarpoolRequest> batch;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            batch.swap(pending);
+        }
+        std::lock_guard<std::mutex> solveLock(solveMutex);
+        solveBatch(batch);
+    }
+
+    std::size_t getPendingCount() {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        return pending.size();
+    }
+
+    // Greedy clustering: oldest unassigned request seeds a group, later requests of the
+    // same vehicle type join while their pickups, dropoffs and heading stay close
+    static std::vector<CarpoolCluster> formClusters(const std::vector<PendingCarpoolRequest>& batch,
+                                                    const CarpoolBatchConfig& config) {
+        std::vector<std::size_t> order(batch.size());
+        for (std::size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return batch[a].requestedAt < batch[b].requestedAt;
+        });
+
+        std::vector<CarpoolCluster> clusters;
+        std::vector<bool> grouped(batch.size(), false);
+        for (std::size_t i = 0; i < order.size(); i++) {
+            std::size_t seedIndex = order[i];
+            if (grouped[seedIndex]) {
+                continue;
+            }
+            const PendingCarpoolRequest& seed = batch[seedIndex];
+            int seedHeading = GeoUtils::headingBucket(seed.pickup, seed.dropoff, config.headingBuckets);
+
+            CarpoolCluster cluster{seed.vehicleType, {seedIndex}, seed.passengerCount};
+            grouped[seedIndex] = true;
+
+            for (std::size_t j = i + 1; j < order.size() && cluster.seats < config.maxGroupSeats; j++) {
+                std::size_t candidateIndex = order[j];
+                const PendingCarpoolRequest& candidate = batch[candidateIndex];
+                if (grouped[candidateIndex] || candidate.vehicleType != seed.vehicleType ||
+                    cluster.seats + candidate.passengerCount > config.maxGroupSeats) {
+                    continue;
+                }
+                if (candidate.requestedAt - seed.requestedAt > config.window) {
+                    break; // sorted by time, nothing later can join
+                }
+                if (GeoUtils::headingBucket(candidate.pickup, candidate.dropoff, config.headingBuckets) != seedHeading ||
+                    GeoUtils::distanceKm(candidate.pickup, seed.pickup) > config.maxPickupSpreadKm ||
+                    GeoUtils::distanceKm(candidate.dropoff, seed.dropoff) > config.maxDropoffSpreadKm) {
+                    continue;
+                }
+                cluster.members.push_back(candidateIndex);
+                cluster.seats += candidate.passengerCount;
+                grouped[candidateIndex] = true;
+            }
+            clusters.push_back(std::move(cluster));
+        }
+        return clusters;
+    }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef CARPOOL_GROUP_INDEX_H
+#define CARPOOL_GROUP_INDEX_H
+
+#include "User.h"
+#include "GeoUtils.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+// Active carpool groups bucketed by (destination cell, heading sector). A new
+// request probes only the cells around its own dropoff in its own and the two
+// adjacent heading sectors, instead of scanning every driver.
+class CarpoolGroupIndex {
+private:
+    double cellSizeDegrees;
+    int headingBuckets;
+    std::unordered_map<std::uint64_t, std::vector<std::string>> buckets; // key -> driver IDs
+    std::unordered_map<std::string, std::uint64_t> driverKeys;           // driver -> current key
+
+    static std::uint64_t makeKey(int latCell, int lngCell, int heading) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(latCell)) << 32) |
+               ((static_cast<std::uint64_t>(static_cast<std::uint32_t>(lngCell)) & 0xFFFFFF) << 8) |
+               static_cast<std::uint64_t>(heading & 0xFF);
+    }
+
+public:
+    CarpoolGroupIndex(double cellSizeDegrees = 0.02, int headingBuckets = 8)
+        : cellSizeDegrees(cellSizeDegrees), headingBuckets(headingBuckets) {}
+
+    // (Re)indexes a driver's group by where it is now and where its route ends
+    void update(const std::string& driverId, const GeoPoint& origin, const GeoPoint& destination) {
+        std::uint64_t key = makeKey(GeoUtils::cellCoordinate(destination.latitudeE6, cellSizeDegrees),
+                                    GeoUtils::cellCoordinate(destination.longitudeE6, cellSizeDegrees),
+                                    GeoUtils::headingBucket(origin, destination, headingBuckets));
+        auto existing = driverKeys.find(driverId);
+        if (existing != driverKeys.end()) {
+            if (existing->second == key) {
+                return;
+            }
+            remove(driverId);
+        }
+        buckets[key].push_back(driverId);
+        driverKeys[driverId] = key;
+    }
+
+    void remove(const std::string& driverId) {
+        auto existing = driverKeys.find(driverId);
+        if (existing == driverKeys.end()) {
+            return;
+        }
+        auto bucket = buckets.find(existing->second);
+        if (bucket != buckets.end()) {
+            auto& members = bucket->second;
+            auto it = std::find(members.begin(), members.end(), driverId);
+            if (it != members.end()) {
+                *it = members.back();
+                members.pop_back();
+            }
+            if (members.empty()) {
+                buckets.erase(bucket);
+            }
+        }
+        driverKeys.erase(existing);
+    }
+
+    // Drivers whose groups end near the dropoff and head the same way as the request;
+    // bucketsProbed, if given, receives the number of bucket lookups made
+    std::vector<std::string> findCompatibleGroups(const GeoPoint& pickup, const GeoPoint& dropoff,
+                                                  std::size_t* bucketsProbed = nullptr) const {
+        std::vector<std::string> result;
+        if (bucketsProbed) {
+            *bucketsProbed = 0;
+        }
+        if (buckets.empty()) {
+            return result;
+        }
+
+        int latCell = GeoUtils::cellCoordinate(dropoff.latitudeE6, cellSizeDegrees);
+        int lngCell = GeoUtils::cellCoordinate(dropoff.longitudeE6, cellSizeDegrees);
+        int heading = GeoUtils::headingBucket(pickup, dropoff, headingBuckets);
+
+        for (int dLat = -1; dLat <= 1; dLat++) {
+            for (int dLng = -1; dLng <= 1; dLng++) {
+                for (int dHeading = -1; dHeading <= 1; dHeading++) {
+                    int sector = (heading + dHeading + headingBuckets) % headingBuckets;
+                    auto bucket = buckets.find(makeKey(latCell + dLat, lngCell + dLng, sector));
+                    if (bucketsProbed) {
+                        ++*bucketsProbed;
+                    }
+                    if (bucket != buckets.end()) {
+                        result.insert(result.end(), bucket->second.begin(), bucket->second.end());
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    void clear() {
+        buckets.clear();
+        driverKeys.clear();
+    }
+
+    std::size_t size() const { return driverKeys.size(); }
+};
+
+#endif
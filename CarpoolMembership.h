@@ -0,0 +1,87 @@
+#ifndef CARPOOL_MEMBERSHIP_H
+#define CARPOOL_MEMBERSHIP_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Which rides share each driver's vehicle. Drivers and rides are addressed by
+// dense integer IDs handed out by RideManager, each driver owns a fixed-size
+// seat array, and every ride remembers its slot, so join and leave are O(1)
+// and the number of non-empty groups is kept exact.
+class CarpoolMembership {
+public:
+    static constexpr std::size_t MAX_SEATS = 8;
+    static constexpr std::uint32_t NO_DRIVER = 0xFFFFFFFFu;
+
+private:
+    struct Group {
+        std::uint32_t rides[MAX_SEATS];
+        std::uint8_t size = 0;
+    };
+
+    struct Seat {
+        std::uint32_t driver = NO_DRIVER;
+        std::uint8_t slot = 0;
+    };
+
+    std::vector<Group> groups; // indexed by dense driver ID
+    std::vector<Seat> seats;   // indexed by dense ride ID
+    std::size_t activeGroups = 0;
+
+public:
+    // Returns false when the driver's seat array is already full
+    bool join(std::uint32_t driver, std::uint32_t ride) {
+        if (driver >= groups.size()) {
+            groups.resize(driver + 1);
+        }
+        if (ride >= seats.size()) {
+            seats.resize(ride + 1);
+        }
+
+        Group& group = groups[driver];
+        if (group.size == MAX_SEATS || seats[ride].driver != NO_DRIVER) {
+            return false;
+        }
+        if (group.size == 0) {
+            activeGroups++;
+        }
+
+        group.rides[group.size] = ride;
+        seats[ride].driver = driver;
+        seats[ride].slot = group.size;
+        group.size++;
+        return true;
+    }
+
+    // Frees the ride's seat (no-op if it holds none); returns its driver or NO_DRIVER
+    std::uint32_t leave(std::uint32_t ride) {
+        if (ride >= seats.size() || seats[ride].driver == NO_DRIVER) {
+            return NO_DRIVER;
+        }
+
+        std::uint32_t driver = seats[ride].driver;
+        Group& group = groups[driver];
+        std::uint8_t slot = seats[ride].slot;
+
+        // Move the last occupant into the freed slot
+        std::uint32_t moved = group.rides[group.size - 1];
+        group.rides[slot] = moved;
+        seats[moved].slot = slot;
+        group.size--;
+
+        seats[ride].driver = NO_DRIVER;
+        if (group.size == 0) {
+            activeGroups--;
+        }
+        return driver;
+    }
+
+    std::size_t getGroupSize(std::uint32_t driver) const {
+        return driver < groups.size() ? groups[driver].size : 0;
+    }
+
+    std::size_t getActiveGroupCount() const { return activeGroups; }
+};
+
+#endif
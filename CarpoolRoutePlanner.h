@@ -0,0 +1,382 @@
+#ifndef CARPOOL_ROUTE_PLANNER_H
+#define CARPOOL_ROUTE_PLANNER_H
+
+#include "User.h"
+#include "GeoUtils.h"
+#include "CarpoolGroupIndex.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+
+struct CarpoolMatchingConfig {
+    double maxDetourRatio = 1.5;      // in-vehicle distance limit, as a multiple of the direct distance
+    double maxPickupDistanceKm = 8.0; // how far a driver may travel (along the route) to a new pickup
+    int maxFullEvaluations = 8;       // candidates whose routes are fully evaluated per request
+    double groupCellSizeDegrees = 0.02; // destination cell size of the active group index
+    int groupHeadingBuckets = 8;        // heading sectors of the active group index
+};
+
+struct RouteStop {
+    std::string rideId;
+    GeoPoint location;
+    bool isPickup;
+    int passengers; // party size boarding or leaving here
+
+    RouteStop(const std::string& rideId, const GeoPoint& location, bool isPickup, int passengers = 1)
+        : rideId(rideId), location(location), isPickup(isPickup), passengers(passengers) {}
+};
+
+// Result of evaluating a new pickup/dropoff pair against a driver's route.
+// driver is null when no candidate can take the rider.
+struct CarpoolInsertion {
+    std::shared_ptr<Driver> driver;
+    GeoPoint driverLocation;      // driver position the insertion was evaluated from
+    std::size_t pickupIndex = 0;  // positions in the new stop sequence
+    std::size_t dropoffIndex = 0;
+    double pickupDistanceKm = 0.0; // route distance from the driver to the new pickup
+    double addedDistanceKm = 0.0;  // growth of the driver's total route
+
+    double cost() const { return pickupDistanceKm + addedDistanceKm; }
+};
+
+// Keeps every carpool driver's pending stop sequence and matches new riders by
+// evaluating all pickup/dropoff insertion positions. An insertion is accepted
+// only if no rider (existing or new) exceeds maxDetourRatio times their direct
+// distance and the occupied seats on every leg stay within the vehicle's
+// capacity (checked against per-segment load counters). Riders already on
+// board keep the distance they have ridden so far charged against their
+// limit. Candidates are ranked by a straight-line lower bound on the cost so
+// only a few routes need a full evaluation.
+class CarpoolRoutePlanner {
+private:
+    struct DriverRoute {
+        GeoPoint origin; // driver position when the route last changed
+        std::vector<RouteStop> stops;
+        std::vector<int> segmentLoad; // seats occupied on the leg into stops[k]; last entry is after the final stop
+    };
+
+    std::unordered_map<std::string, DriverRoute> routes;        // driver -> pending stops
+    std::unordered_map<std::string, double> rideDistanceLimits; // ride -> max in-vehicle km
+    std::unordered_map<std::string, double> rideConsumedKm;     // on-board ride -> km ridden up to its route's origin
+    CarpoolMatchingConfig config;
+    CarpoolGroupIndex groupIndex;
+
+    // Scratch buffers reused across evaluations
+    std::vector<const RouteStop*> sequence;
+    std::vector<double> arrivalKm;
+
+    static const std::vector<RouteStop>& emptyRoute() {
+        static const std::vector<RouteStop> empty;
+        return empty;
+    }
+
+    static const std::vector<int>& emptyRouteLoad() {
+        static const std::vector<int> empty{0};
+        return empty;
+    }
+
+    const std::vector<int>& loadFor(const std::string& driverId) const {
+        auto it = routes.find(driverId);
+        return it != routes.end() ? it->second.segmentLoad : emptyRouteLoad();
+    }
+
+    // Riders whose pickup is no longer in the route are on board now
+    static void recomputeLoad(DriverRoute& route) {
+        int onBoard = 0;
+        for (const auto& stop : route.stops) {
+            if (!stop.isPickup) {
+                onBoard += stop.passengers;
+            }
+        }
+        for (const auto& stop : route.stops) {
+            if (stop.isPickup) {
+                onBoard -= stop.passengers;
+            }
+        }
+
+        route.segmentLoad.resize(route.stops.size() + 1);
+        route.segmentLoad[0] = onBoard;
+        for (std::size_t k = 0; k < route.stops.size(); k++) {
+            onBoard += route.stops[k].isPickup ? route.stops[k].passengers : -route.stops[k].passengers;
+            route.segmentLoad[k + 1] = onBoard;
+        }
+    }
+
+    static bool isOnBoard(const std::vector<RouteStop>& stops, const RouteStop& dropoff) {
+        return std::none_of(stops.begin(), stops.end(), [&](const RouteStop& stop) {
+            return stop.isPickup && stop.rideId == dropoff.rideId;
+        });
+    }
+
+    double consumedKm(const std::string& rideId) const {
+        auto it = rideConsumedKm.find(rideId);
+        return it != rideConsumedKm.end() ? it->second : 0.0;
+    }
+
+    // Moves the route's origin to the driver's position, charging the distance
+    // covered since (straight line, a lower bound) to every rider on board
+    void advance(DriverRoute& route, const GeoPoint& position) {
+        if (!route.stops.empty()) {
+            double movedKm = GeoUtils::distanceKm(route.origin, position);
+            for (const auto& stop : route.stops) {
+                if (!stop.isPickup && isOnBoard(route.stops, stop)) {
+                    rideConsumedKm[stop.rideId] += movedKm;
+                }
+            }
+        }
+        route.origin = position;
+    }
+
+    const std::vector<RouteStop>& routeFor(const std::string& driverId) const {
+        auto it = routes.find(driverId);
+        return it != routes.end() ? it->second.stops : emptyRoute();
+    }
+
+    // Keeps the group index in step with a route change; empty routes leave the index
+    void reindex(const std::string& driverId, const GeoPoint& origin) {
+        auto it = routes.find(driverId);
+        if (it == routes.end()) {
+            groupIndex.remove(driverId);
+            return;
+        }
+        if (it->second.stops.empty()) {
+            routes.erase(it);
+            groupIndex.remove(driverId);
+            return;
+        }
+        it->second.origin = origin;
+        recomputeLoad(it->second);
+        groupIndex.update(driverId, origin, it->second.stops.back().location);
+    }
+
+    static double routeLength(const GeoPoint& start, const std::vector<RouteStop>& stops) {
+        double length = 0.0;
+        const GeoPoint* previous = &start;
+        for (const auto& stop : stops) {
+            length += GeoUtils::distanceKm(*previous, stop.location);
+            previous = &stop.location;
+        }
+        return length;
+    }
+
+    // Checks every rider's in-vehicle distance on the candidate sequence and fills
+    // arrivalKm (cumulative distance from the driver to each stop).
+    // sinceOriginKm is how far the driver is from its route's origin.
+    bool sequenceWithinLimits(const GeoPoint& start, const RouteStop& newPickup,
+                              double newRideLimitKm, double sinceOriginKm) {
+        arrivalKm.resize(sequence.size());
+        double travelled = 0.0;
+        const GeoPoint* previous = &start;
+        for (std::size_t i = 0; i < sequence.size(); i++) {
+            travelled += GeoUtils::distanceKm(*previous, sequence[i]->location);
+            arrivalKm[i] = travelled;
+            previous = &sequence[i]->location;
+        }
+
+        for (std::size_t i = 0; i < sequence.size(); i++) {
+            const RouteStop* stop = sequence[i];
+            if (stop->isPickup) {
+                continue;
+            }
+
+            // Riders already on board boarded before the driver's position, by
+            // what they have ridden so far
+            bool boardsInSequence = false;
+            double boardedAtKm = 0.0;
+            for (std::size_t k = 0; k < i; k++) {
+                if (sequence[k]->isPickup && sequence[k]->rideId == stop->rideId) {
+                    boardedAtKm = arrivalKm[k];
+                    boardsInSequence = true;
+                    break;
+                }
+            }
+            if (!boardsInSequence) {
+                boardedAtKm = -(consumedKm(stop->rideId) + sinceOriginKm);
+            }
+
+            double limit = newRideLimitKm;
+            if (stop->rideId != newPickup.rideId) {
+                auto limitIt = rideDistanceLimits.find(stop->rideId);
+                limit = limitIt != rideDistanceLimits.end() ? limitIt->second
+                                                            : std::numeric_limits<double>::max();
+            }
+            if (arrivalKm[i] - boardedAtKm > limit) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Best feasible insertion of (pickup, dropoff) into one driver's route
+    bool evaluateDriver(const std::shared_ptr<Driver>& driver, const GeoPoint& start, const RouteStop& pickup,
+                        const RouteStop& dropoff, double newRideLimitKm, CarpoolInsertion& best) {
+        const std::vector<RouteStop>& stops = routeFor(driver->getUserId());
+        const std::vector<int>& load = loadFor(driver->getUserId());
+        auto route = routes.find(driver->getUserId());
+        double sinceOriginKm = route != routes.end() ? GeoUtils::distanceKm(route->second.origin, start) : 0.0;
+        int capacity = driver->getVehicle().capacity;
+        double currentLength = routeLength(start, stops);
+        bool found = false;
+
+        for (std::size_t p = 0; p <= stops.size(); p++) {
+            // The new party rides on legs p..d-1 of the current route; a full leg
+            // rules out this and every later dropoff position
+            int peakLoad = 0;
+            for (std::size_t d = p + 1; d <= stops.size() + 1; d++) {
+                peakLoad = std::max(peakLoad, load[d - 1]);
+                if (peakLoad + pickup.passengers > capacity) {
+                    break;
+                }
+
+                sequence.clear();
+                for (std::size_t k = 0, s = 0; k < stops.size() + 2; k++) {
+                    if (k == p) sequence.push_back(&pickup);
+                    else if (k == d) sequence.push_back(&dropoff);
+                    else sequence.push_back(&stops[s++]);
+                }
+
+                if (!sequenceWithinLimits(start, pickup, newRideLimitKm, sinceOriginKm)) {
+                    continue;
+                }
+
+                double pickupDistance = arrivalKm[p];
+                if (pickupDistance > config.maxPickupDistanceKm) {
+                    continue;
+                }
+
+                double addedDistance = arrivalKm.back() - currentLength;
+                double cost = pickupDistance + addedDistance;
+                if (!best.driver || cost < best.cost()) {
+                    best.driver = driver;
+                    best.driverLocation = start;
+                    best.pickupIndex = p;
+                    best.dropoffIndex = d;
+                    best.pickupDistanceKm = pickupDistance;
+                    best.addedDistanceKm = addedDistance;
+                    found = true;
+                }
+            }
+        }
+        return found;
+    }
+
+public:
+    CarpoolRoutePlanner() : groupIndex(config.groupCellSizeDegrees, config.groupHeadingBuckets) {}
+
+    void setConfig(const CarpoolMatchingConfig& newConfig) {
+        config = newConfig;
+        groupIndex = CarpoolGroupIndex(config.groupCellSizeDegrees, config.groupHeadingBuckets);
+        for (const auto& route : routes) {
+            groupIndex.update(route.first, route.second.origin, route.second.stops.back().location);
+        }
+    }
+    const CarpoolMatchingConfig& getConfig() const { return config; }
+
+    // Drivers with active groups heading toward this dropoff (small bucket probe)
+    std::vector<std::string> findCompatibleGroups(const GeoPoint& pickup, const GeoPoint& dropoff,
+                                                  std::size_t* bucketsProbed = nullptr) const {
+        return groupIndex.findCompatibleGroups(pickup, dropoff, bucketsProbed);
+    }
+
+    bool hasActiveRoute(const std::string& driverId) const {
+        return routes.count(driverId) > 0;
+    }
+
+    // Candidates must already be filtered for vehicle type; seats are checked here.
+    // positions[i] is the current position of candidates[i].
+    CarpoolInsertion findBestInsertion(const std::vector<std::shared_ptr<Driver>>& candidates,
+                                       const std::vector<GeoPoint>& positions,
+                                       const std::string& rideId,
+                                       const GeoPoint& pickupLocation,
+                                       const GeoPoint& dropoffLocation,
+                                       int passengers = 1) {
+        RouteStop pickup(rideId, pickupLocation, true, passengers);
+        RouteStop dropoff(rideId, dropoffLocation, false, passengers);
+        double newRideLimitKm = GeoUtils::distanceKm(pickupLocation, dropoffLocation) * config.maxDetourRatio;
+
+        // Lower bound: the driver must at least cover the straight line to the pickup,
+        // and inserting stops never shortens a route
+        std::vector<std::pair<double, std::size_t>> ranked;
+        ranked.reserve(candidates.size());
+        for (std::size_t i = 0; i < candidates.size(); i++) {
+            double lowerBound = GeoUtils::distanceKm(positions[i], pickupLocation);
+            if (lowerBound <= config.maxPickupDistanceKm) {
+                ranked.emplace_back(lowerBound, i);
+            }
+        }
+        std::sort(ranked.begin(), ranked.end());
+
+        CarpoolInsertion best;
+        int evaluations = 0;
+        for (const auto& entry : ranked) {
+            if (evaluations >= config.maxFullEvaluations) {
+                break;
+            }
+            if (best.driver && entry.first >= best.cost()) {
+                break; // no remaining candidate can beat the best insertion
+            }
+            evaluateDriver(candidates[entry.second], positions[entry.second],
+                           pickup, dropoff, newRideLimitKm, best);
+            evaluations++;
+        }
+        return best;
+    }
+
+    void commitInsertion(const CarpoolInsertion& insertion, const std::string& rideId,
+                         const GeoPoint& pickupLocation, const GeoPoint& dropoffLocation,
+                         int passengers = 1) {
+        const std::string& driverId = insertion.driver->getUserId();
+        DriverRoute& route = routes[driverId];
+        advance(route, insertion.driverLocation);
+        auto& stops = route.stops;
+        stops.insert(stops.begin() + insertion.pickupIndex, RouteStop(rideId, pickupLocation, true, passengers));
+        stops.insert(stops.begin() + insertion.dropoffIndex, RouteStop(rideId, dropoffLocation, false, passengers));
+        rideDistanceLimits[rideId] = GeoUtils::distanceKm(pickupLocation, dropoffLocation) * config.maxDetourRatio;
+        reindex(driverId, insertion.driverLocation);
+    }
+
+    // Rider boarded: drop the pickup stop, keep the dropoff
+    void markPickedUp(const std::string& driverId, const GeoPoint& driverLocation, const std::string& rideId) {
+        auto it = routes.find(driverId);
+        if (it == routes.end()) {
+            return;
+        }
+        advance(it->second, driverLocation);
+        auto& stops = it->second.stops;
+        stops.erase(std::remove_if(stops.begin(), stops.end(),
+                                   [&](const RouteStop& stop) { return stop.isPickup && stop.rideId == rideId; }),
+                    stops.end());
+        rideConsumedKm[rideId] = 0.0; // boards here, at the new origin
+        reindex(driverId, driverLocation);
+    }
+
+    // Ride completed or cancelled: drop all of its remaining stops
+    void removeRide(const std::string& driverId, const GeoPoint& driverLocation, const std::string& rideId) {
+        rideDistanceLimits.erase(rideId);
+        auto it = routes.find(driverId);
+        if (it != routes.end()) {
+            advance(it->second, driverLocation);
+            auto& stops = it->second.stops;
+            stops.erase(std::remove_if(stops.begin(), stops.end(),
+                                       [&](const RouteStop& stop) { return stop.rideId == rideId; }),
+                        stops.end());
+            reindex(driverId, driverLocation);
+        }
+        rideConsumedKm.erase(rideId);
+    }
+
+    const std::vector<RouteStop>& getRoute(const std::string& driverId) const {
+        return routeFor(driverId);
+    }
+
+    // Seats occupied right now (before the next stop)
+    int getOccupiedSeats(const std::string& driverId) const {
+        return loadFor(driverId).front();
+    }
+};
+
+#endif
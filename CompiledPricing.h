@@ -0,0 +1,172 @@
+#ifndef COMPILED_PRICING_H
+#define COMPILED_PRICING_H
+
+#include "RideTypes.h"
+#include "PricingStrategy.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <stdexcept>
+#include <algorithm>
+
+// One pricing rule in application order (innermost decorator first)
+enum class PricingStepKind {
+    SURGE,
+    DISCOUNT,
+    TOLL
+};
+
+struct PricingStep {
+    PricingStepKind kind;
+    double value; // multiplier, discount percentage or toll amount
+
+    PricingStep(PricingStepKind kind, double value) : kind(kind), value(value) {}
+};
+
+// Declarative description of a decorator stack. The same plan can be turned into
+// the reference decorator chain or into a CompiledPricingCalculator.
+class PricingPlan {
+private:
+    std::vector<PricingStep> steps;
+
+public:
+    PricingPlan& surge(double multiplier) {
+        steps.emplace_back(PricingStepKind::SURGE, multiplier);
+        return *this;
+    }
+
+    PricingPlan& discount(double percentage) {
+        steps.emplace_back(PricingStepKind::DISCOUNT, percentage);
+        return *this;
+    }
+
+    PricingPlan& toll(double amount) {
+        steps.emplace_back(PricingStepKind::TOLL, amount);
+        return *this;
+    }
+
+    const std::vector<PricingStep>& getSteps() const { return steps; }
+
+    // Builds the original decorator chain: Base wrapped by each step in order
+    std::unique_ptr<PricingCalculator> buildDecoratorChain() const {
+        std::unique_ptr<PricingCalculator> calculator = std::make_unique<BasePricingCalculator>();
+        for (const auto& step : steps) {
+            switch (step.kind) {
+                case PricingStepKind::SURGE:
+                    calculator = std::make_unique<SurgePricingDecorator>(std::move(calculator), step.value);
+                    break;
+                case PricingStepKind::DISCOUNT:
+                    calculator = std::make_unique<DiscountDecorator>(std::move(calculator), step.value);
+                    break;
+                case PricingStepKind::TOLL:
+                    calculator = std::make_unique<TollDecorator>(std::move(calculator), step.value);
+                    break;
+            }
+        }
+        return calculator;
+    }
+};
+
+// Flattened pricing engine: the whole decorator stack is evaluated from a
+// contiguous step array with per-vehicle constants looked up from tables, so a
+// fare costs one loop instead of a chain of virtual calls. Every step performs
+// the same floating point operations in the same order as the decorators,
+// which keeps results bit-identical to the reference chain.
+class CompiledPricingCalculator : public PricingCalculator {
+private:
+    static constexpr std::size_t VEHICLE_TYPE_COUNT = 4;
+    static constexpr std::size_t FALLBACK_VEHICLE = VEHICLE_TYPE_COUNT; // unknown types: factory defaults
+
+    struct CompiledStep {
+        PricingStepKind kind;
+        double operand; // surge multiplier, discount factor or toll amount
+    };
+
+    std::vector<CompiledStep> steps;
+    double baseFares[VEHICLE_TYPE_COUNT + 1];
+    double perKmRates[VEHICLE_TYPE_COUNT + 1];
+    double minimumDiscountedFares[VEHICLE_TYPE_COUNT + 1];
+
+    static std::size_t vehicleIndex(VehicleType type) {
+        std::size_t index = static_cast<std::size_t>(type);
+        return index < VEHICLE_TYPE_COUNT ? index : FALLBACK_VEHICLE;
+    }
+
+    double evaluate(double distance, std::size_t vehicle) const {
+        if (distance < 0) {
+            throw std::invalid_argument("Distance cannot be negative");
+        }
+
+        double baseFare = baseFares[vehicle];
+        double fare = std::max(baseFare + (distance * perKmRates[vehicle]), baseFare);
+
+        for (const auto& step : steps) {
+            switch (step.kind) {
+                case PricingStepKind::SURGE:
+                    fare = fare * step.operand;
+                    break;
+                case PricingStepKind::DISCOUNT:
+                    fare = std::max(fare * step.operand, minimumDiscountedFares[vehicle]);
+                    break;
+                case PricingStepKind::TOLL:
+                    fare = fare + step.operand;
+                    break;
+            }
+        }
+        return fare;
+    }
+
+public:
+    explicit CompiledPricingCalculator(const PricingPlan& plan = PricingPlan()) {
+        // The extra last entry takes the factory's default branch, as the decorators do
+        for (std::size_t i = 0; i <= VEHICLE_TYPE_COUNT; i++) {
+            VehicleType type = static_cast<VehicleType>(i);
+            baseFares[i] = VehicleTypeFactory::getBaseFare(type);
+            perKmRates[i] = VehicleTypeFactory::getPerKmRate(type);
+            minimumDiscountedFares[i] = VehicleTypeFactory::getBaseFare(type) * 0.5;
+        }
+
+        // Same validation (and messages) as the decorator constructors
+        for (const auto& step : plan.getSteps()) {
+            switch (step.kind) {
+                case PricingStepKind::SURGE:
+                    if (step.value <= 0) {
+                        throw std::invalid_argument("Surge multiplier must be positive");
+                    }
+                    if (step.value > 5.0) {
+                        throw std::invalid_argument("Surge multiplier cannot exceed 5x for regulatory compliance");
+                    }
+                    steps.push_back({step.kind, step.value});
+                    break;
+                case PricingStepKind::DISCOUNT:
+                    if (step.value < 0 || step.value > 100) {
+                        throw std::invalid_argument("Discount percentage must be between 0 and 100");
+                    }
+                    steps.push_back({step.kind, 1.0 - step.value / 100.0});
+                    break;
+                case PricingStepKind::TOLL:
+                    if (step.value < 0) {
+                        throw std::invalid_argument("Toll amount cannot be negative");
+                    }
+                    steps.push_back({step.kind, step.value});
+                    break;
+            }
+        }
+    }
+
+    double calculateFare(double distance, VehicleType vehicleType) override {
+        return evaluate(distance, vehicleIndex(vehicleType));
+    }
+
+    // Batch form for callers pricing many rides at once
+    void calculateFares(const double* distances, const VehicleType* vehicleTypes,
+                        double* fares, std::size_t count) const {
+        for (std::size_t i = 0; i < count; i++) {
+            fares[i] = evaluate(distances[i], vehicleIndex(vehicleTypes[i]));
+        }
+    }
+
+    std::size_t getStepCount() const { return steps.size(); }
+};
+
+#endif
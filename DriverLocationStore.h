@@ -0,0 +1,260 @@
+#ifndef DRIVER_LOCATION_STORE_H
+#define DRIVER_LOCATION_STORE_H
+
+#include "User.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+// One GPS report; driverSlot is the dense ID from RideManager::getDriverSlot
+struct DriverLocationUpdate {
+    std::uint32_t driverSlot;
+    GeoPoint position;
+    std::int64_t timestampMs;
+    std::uint32_t zoneId = 0xFFFFFFFFu; // geofence zone at this position, tagged by RideManager
+};
+
+// Driver coordinates in structure-of-arrays form (int32 micro-degree columns), double-buffered. Ingestion
+// writes a whole batch into the back buffer and then publishes it by flipping
+// the front index; readers copy from the front buffer and use its version
+// counter (seqlock) to detect the rare case of a writer lapping them, in which
+// case they retry. Neither side ever waits for the other.
+//
+// Each report also updates the driver's velocity (from the previous fix), so
+// readers can dead-reckon where a driver is between reports.
+class DriverLocationStore {
+public:
+    // Faster implied movement between two fixes is treated as GPS noise
+    static constexpr double MAX_SPEED_KMH = 150.0;
+
+private:
+    // Column of atomics stored in fixed-size chunks. Growing only adds chunks, so
+    // entries never move and readers need no lock against addDriver. Relaxed
+    // accesses compile to plain loads/stores.
+    template <typename T>
+    class AtomicColumn {
+    public:
+        static constexpr std::size_t CHUNK_SIZE = 4096;
+        static constexpr std::size_t MAX_CHUNKS = 1024;
+
+    private:
+        std::atomic<std::atomic<T>*> chunks[MAX_CHUNKS] = {};
+        std::vector<std::unique_ptr<std::atomic<T>[]>> owned; // writer side only
+        std::size_t capacity = 0;
+
+    public:
+        void grow(std::size_t newCapacity) {
+            while (capacity < newCapacity) {
+                std::unique_ptr<std::atomic<T>[]> chunk(new std::atomic<T>[CHUNK_SIZE]);
+                for (std::size_t i = 0; i < CHUNK_SIZE; i++) {
+                    chunk[i].store(T(), std::memory_order_relaxed);
+                }
+                chunks[owned.size()].store(chunk.get(), std::memory_order_release);
+                owned.push_back(std::move(chunk));
+                capacity += CHUNK_SIZE;
+            }
+        }
+
+        T load(std::size_t i) const {
+            return chunks[i / CHUNK_SIZE].load(std::memory_order_acquire)[i % CHUNK_SIZE].load(
+                std::memory_order_relaxed);
+        }
+        void store(std::size_t i, T value) {
+            chunks[i / CHUNK_SIZE].load(std::memory_order_relaxed)[i % CHUNK_SIZE].store(
+                value, std::memory_order_relaxed);
+        }
+        std::size_t getCapacity() const { return capacity; }
+    };
+
+    struct Buffer {
+        std::atomic<std::uint64_t> version{0}; // odd while a batch is being written
+        AtomicColumn<std::int32_t> latitudes;
+        AtomicColumn<std::int32_t> longitudes;
+        AtomicColumn<std::int64_t> timestamps;
+        AtomicColumn<float> latitudeVelocities;  // micro-degrees per second
+        AtomicColumn<float> longitudeVelocities;
+        AtomicColumn<std::uint32_t> zones;
+    };
+
+    Buffer buffers[2];
+    static constexpr std::size_t MAX_DRIVERS =
+        AtomicColumn<std::int32_t>::CHUNK_SIZE * AtomicColumn<std::int32_t>::MAX_CHUNKS;
+    std::atomic<int> front{0};
+    std::size_t driverCount = 0;
+    std::vector<DriverLocationUpdate> unsyncedBatch; // published in front, not yet in back
+    std::mutex writerMutex;                           // serializes writers only
+
+    // Velocity comes from the previous fix in the same buffer. Both buffers see the
+    // same sequence of reports, so they always derive the same motion state. A fix
+    // no newer than the stored one arrived late or out of order and is dropped.
+    static void apply(Buffer& buffer, const DriverLocationUpdate& update) {
+        std::uint32_t slot = update.driverSlot;
+        std::int64_t elapsedMs = update.timestampMs - buffer.timestamps.load(slot);
+        if (elapsedMs <= 0) {
+            return;
+        }
+        float latitudeVelocity = 0.0f;
+        float longitudeVelocity = 0.0f;
+        if (buffer.timestamps.load(slot) > 0) {
+            double seconds = elapsedMs / 1000.0;
+            double dLat = (static_cast<double>(update.position.latitudeE6) - buffer.latitudes.load(slot)) / seconds;
+            double dLng = (static_cast<double>(update.position.longitudeE6) - buffer.longitudes.load(slot)) / seconds;
+            double maxUnitsPerSecond = MAX_SPEED_KMH / 3600.0 / 111.0 * GeoPoint::UNITS_PER_DEGREE;
+            if (dLat * dLat + dLng * dLng <= maxUnitsPerSecond * maxUnitsPerSecond) {
+                latitudeVelocity = static_cast<float>(dLat);
+                longitudeVelocity = static_cast<float>(dLng);
+            }
+        }
+        store(buffer, update, latitudeVelocity, longitudeVelocity);
+    }
+
+    static void store(Buffer& buffer, const DriverLocationUpdate& update, float latitudeVelocity,
+                      float longitudeVelocity) {
+        std::uint32_t slot = update.driverSlot;
+        buffer.latitudes.store(slot, update.position.latitudeE6);
+        buffer.longitudes.store(slot, update.position.longitudeE6);
+        buffer.timestamps.store(slot, update.timestampMs);
+        buffer.latitudeVelocities.store(slot, latitudeVelocity);
+        buffer.longitudeVelocities.store(slot, longitudeVelocity);
+        buffer.zones.store(slot, update.zoneId);
+    }
+
+    // Seqlock-validated copy of several drivers' positions, each advanced along its
+    // velocity by the time since its last fix (capped at horizonMs; 0 = no prediction)
+    void snapshot(const std::uint32_t* slots, std::size_t count, GeoPoint* positions,
+                  std::int64_t nowMs, std::int64_t horizonMs) const {
+        for (;;) {
+            const Buffer& buffer = buffers[front.load(std::memory_order_acquire)];
+            std::uint64_t before = buffer.version.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                std::uint32_t slot = slots[i];
+                positions[i] = GeoPoint{buffer.latitudes.load(slot), buffer.longitudes.load(slot)};
+                if (horizonMs > 0) {
+                    std::int64_t elapsedMs = std::min(nowMs - buffer.timestamps.load(slot), horizonMs);
+                    if (elapsedMs > 0) {
+                        double seconds = elapsedMs / 1000.0;
+                        positions[i].latitudeE6 += static_cast<std::int32_t>(
+                            std::lround(buffer.latitudeVelocities.load(slot) * seconds));
+                        positions[i].longitudeE6 += static_cast<std::int32_t>(
+                            std::lround(buffer.longitudeVelocities.load(slot) * seconds));
+                    }
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (buffer.version.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+    }
+
+public:
+    // Makes room for a newly registered driver. Columns grow by whole chunks and
+    // never move, so this is safe to call while readers are active.
+    void addDriver(std::uint32_t slot, const GeoPoint& position, std::int64_t timestampMs = 0,
+                   std::uint32_t zoneId = 0xFFFFFFFFu) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        if (slot >= MAX_DRIVERS) {
+            throw std::length_error("Driver location store is full");
+        }
+        for (auto& buffer : buffers) {
+            buffer.latitudes.grow(slot + 1);
+            buffer.longitudes.grow(slot + 1);
+            buffer.timestamps.grow(slot + 1);
+            buffer.latitudeVelocities.grow(slot + 1);
+            buffer.longitudeVelocities.grow(slot + 1);
+            buffer.zones.grow(slot + 1);
+        }
+        driverCount = std::max<std::size_t>(driverCount, slot + 1);
+        // Registration starts a fresh motion history. Written under the same version
+        // protocol as a batch so a reader of either buffer never sees a torn entry.
+        DriverLocationUpdate initial{slot, position, timestampMs, zoneId};
+        for (auto& buffer : buffers) {
+            buffer.version.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            store(buffer, initial, 0.0f, 0.0f);
+            buffer.version.fetch_add(1, std::memory_order_release);
+        }
+        // An older report still waiting to reach the back buffer would undo the reset there only
+        unsyncedBatch.erase(std::remove_if(unsyncedBatch.begin(), unsyncedBatch.end(),
+                                           [slot](const DriverLocationUpdate& update) {
+                                               return update.driverSlot == slot;
+                                           }),
+                            unsyncedBatch.end());
+    }
+
+    // Applies a batch of reports and publishes them atomically
+    void ingest(const DriverLocationUpdate* updates, std::size_t count) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        int back = 1 - front.load(std::memory_order_relaxed);
+        Buffer& buffer = buffers[back];
+
+        buffer.version.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (const auto& update : unsyncedBatch) {
+            apply(buffer, update);
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            if (updates[i].driverSlot < driverCount) {
+                apply(buffer, updates[i]);
+            }
+        }
+
+        buffer.version.fetch_add(1, std::memory_order_release);
+        front.store(back, std::memory_order_release);
+
+        unsyncedBatch.clear();
+        for (std::size_t i = 0; i < count; i++) {
+            if (updates[i].driverSlot < driverCount) {
+                unsyncedBatch.push_back(updates[i]);
+            }
+        }
+    }
+
+    void ingest(const std::vector<DriverLocationUpdate>& updates) {
+        ingest(updates.data(), updates.size());
+    }
+
+    // Consistent snapshot of several drivers: all positions come from one published batch
+    void read(const std::uint32_t* slots, std::size_t count, GeoPoint* positions) const {
+        snapshot(slots, count, positions, 0, 0);
+    }
+
+    GeoPoint read(std::uint32_t slot) const {
+        GeoPoint position;
+        read(&slot, 1, &position);
+        return position;
+    }
+
+    // Same snapshot, dead-reckoned to nowMs (never further than horizonMs past a fix)
+    void predict(const std::uint32_t* slots, std::size_t count, GeoPoint* positions,
+                 std::int64_t nowMs, std::int64_t horizonMs) const {
+        snapshot(slots, count, positions, nowMs, horizonMs);
+    }
+
+    GeoPoint predict(std::uint32_t slot, std::int64_t nowMs, std::int64_t horizonMs) const {
+        GeoPoint position;
+        predict(&slot, 1, &position, nowMs, horizonMs);
+        return position;
+    }
+
+    std::int64_t getTimestamp(std::uint32_t slot) const {
+        return buffers[front.load(std::memory_order_acquire)].timestamps.load(slot);
+    }
+
+    // Geofence zone of the driver's last fix
+    std::uint32_t getZone(std::uint32_t slot) const {
+        return buffers[front.load(std::memory_order_acquire)].zones.load(slot);
+    }
+};
+
+#endif
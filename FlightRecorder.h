@@ -0,0 +1,355 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#define RIDEEASY_FLIGHT_POSIX 1
+#endif
+
+enum class FlightEvent : std::uint16_t {
+    REGISTER_RIDER,   // subject: rider count
+    REGISTER_DRIVER,  // subject: driver slot
+    REQUEST_RIDE,     // subject: ride, code: ride type, detail: vehicle type
+    REQUEST_DONE,     // subject: ride, value: latency ns
+    RIDE_STATUS,      // subject: ride, code: new status, detail: previous status
+    DRIVER_STATUS,    // subject: driver slot, code: new status, detail: previous status
+    DRIVER_ASSIGNED,  // subject: ride, detail: driver slot, code: offers made
+    DRIVER_REJECTED,  // subject: ride, detail: driver slot
+    NO_DRIVER,        // subject: ride, detail: candidates
+    COMPLETE_RIDE,    // subject: ride, value: fare in paise
+    LOCATION_UPDATE,  // subject: driver slot, detail: latitudeE6, value: longitudeE6
+    LOCATION_BATCH,   // detail: updates in the batch
+    ANOMALY,          // code: FlightAnomaly, subject/value: trigger-specific
+    COUNT
+};
+
+enum class FlightAnomaly : std::uint16_t { MANUAL, SLOW_REQUEST };
+
+// 32 bytes, written with plain stores into the recording thread's ring
+struct FlightRecord {
+    std::uint64_t ticks;   // FlightRecorder::ticks()
+    std::uint16_t event;   // FlightEvent
+    std::uint16_t code;
+    std::uint32_t subject;
+    std::uint32_t detail;
+    std::uint32_t reserved;
+    std::int64_t value;
+};
+
+enum class FlightDumpReason : std::uint32_t { ON_DEMAND, FATAL_SIGNAL, ANOMALY };
+
+// Always-on black box: every thread appends fixed-size records to its own
+// ring (a timestamp read and five stores, no locks, no allocation after the
+// thread's first record) and the newest records survive. Dumps write all
+// rings unmodified with write(2), so the fatal-signal handler can produce one
+// without allocating or locking. Records being written during a dump may be
+// torn; each ring's sequence numbers show where it was. A ring outlives its
+// thread and is handed to the next new thread, which continues its sequence,
+// so short-lived threads do not use up the MAX_THREADS rings. Off until start().
+class FlightRecorder {
+public:
+    static constexpr std::size_t MAX_THREADS = 256;
+
+private:
+    struct Ring {
+        std::uint32_t threadIndex;
+        std::uint32_t capacity; // power of two
+        std::atomic<std::uint64_t> head{0}; // records ever written
+        std::atomic<bool> owned{true};      // a live thread is writing to it
+        FlightRecord* records;
+    };
+
+    // Hands the calling thread's ring back when the thread exits
+    struct RingLease {
+        Ring* ring = nullptr;
+        bool refused = false;
+        ~RingLease() {
+            if (ring) {
+                ring->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<bool> enabled{false};
+    std::atomic<std::uint32_t> capacity{0};
+    std::atomic<Ring*> rings[MAX_THREADS] = {};
+    std::atomic<std::uint32_t> ringCount{0};
+    std::atomic<std::uint64_t> droppedThreads{0};
+    std::uint64_t startTicks = 0;
+    std::int64_t startNs = 0;
+
+    // Anomaly dumps: path prefix, rate limit and sequence number
+    char anomalyPrefix[256] = {};
+    std::atomic<std::int64_t> lastAnomalyDumpNs{0};
+    std::int64_t anomalyIntervalNs = 0;
+    std::atomic<std::uint32_t> anomalyDumps{0};
+
+    // Fatal-signal dump target, fixed before the handler is installed
+    char crashPath[256] = {};
+
+    FlightRecorder() = default;
+
+    Ring* threadRing() {
+        thread_local RingLease lease;
+        if (lease.ring || lease.refused) {
+            return lease.ring;
+        }
+        // A ring left behind by an exited thread first
+        std::uint32_t count = ringCount.load(std::memory_order_acquire);
+        for (std::uint32_t i = 0; i < count && i < MAX_THREADS; i++) {
+            Ring* ring = rings[i].load(std::memory_order_acquire);
+            bool owned = false;
+            if (ring && ring->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+                lease.ring = ring;
+                return ring;
+            }
+        }
+        std::uint32_t index = ringCount.fetch_add(1, std::memory_order_relaxed);
+        if (index >= MAX_THREADS) {
+            lease.refused = true;
+            droppedThreads.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        // Never freed: a dump, even from a signal handler, may read any ring at any time
+        Ring* ring = new Ring();
+        ring->threadIndex = index;
+        ring->capacity = capacity.load(std::memory_order_relaxed);
+        ring->records = new FlightRecord[ring->capacity]();
+        rings[index].store(ring, std::memory_order_release);
+        lease.ring = ring;
+        return ring;
+    }
+
+    static std::int64_t monotonicNs() {
+#ifdef RIDEEASY_FLIGHT_POSIX
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now); // async-signal-safe
+        return static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    static void copyPath(char* target, std::size_t size, const std::string& path) {
+        if (path.size() >= size) {
+            throw std::invalid_argument("Flight recorder path too long: " + path);
+        }
+        std::memcpy(target, path.c_str(), path.size() + 1);
+    }
+
+    // Header (including how many threads found no ring), then per ring: thread
+    // index, record count, first sequence number
+    // and the records oldest first, all in host byte order (tools/FlightDump.h
+    // reads it back). Sink is called as sink(data, bytes).
+    template <typename Sink>
+    void writeDump(Sink&& sink, FlightDumpReason reason, std::int32_t code) const {
+        std::uint32_t count = ringCount.load(std::memory_order_acquire);
+        count = count < MAX_THREADS ? count : static_cast<std::uint32_t>(MAX_THREADS);
+        const Ring* snapshot[MAX_THREADS];
+        std::uint32_t present = 0;
+        for (std::uint32_t i = 0; i < count; i++) {
+            const Ring* ring = rings[i].load(std::memory_order_acquire);
+            if (ring) {
+                snapshot[present++] = ring; // a thread still setting up its ring is skipped
+            }
+        }
+        std::uint64_t nowTicks = ticks();
+        std::int64_t nowNs = monotonicNs();
+        std::uint32_t reasonValue = static_cast<std::uint32_t>(reason);
+        std::uint64_t dropped = droppedThreads.load(std::memory_order_relaxed);
+
+        sink("RIDEFLT2", 8);
+        sink(&reasonValue, sizeof(reasonValue));
+        sink(&code, sizeof(code));
+        sink(&startTicks, sizeof(startTicks));
+        sink(&startNs, sizeof(startNs));
+        sink(&nowTicks, sizeof(nowTicks));
+        sink(&nowNs, sizeof(nowNs));
+        sink(&dropped, sizeof(dropped));
+        sink(&present, sizeof(present));
+        for (std::uint32_t i = 0; i < present; i++) {
+            const Ring* ring = snapshot[i];
+            std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            std::uint32_t records = head < ring->capacity ? static_cast<std::uint32_t>(head) : ring->capacity;
+            std::uint64_t first = head - records;
+            sink(&ring->threadIndex, sizeof(ring->threadIndex));
+            sink(&records, sizeof(records));
+            sink(&first, sizeof(first));
+            std::uint32_t start = static_cast<std::uint32_t>(first & (ring->capacity - 1));
+            std::uint32_t tail = ring->capacity - start < records ? ring->capacity - start : records;
+            sink(ring->records + start, tail * sizeof(FlightRecord));
+            sink(ring->records, (records - tail) * sizeof(FlightRecord));
+        }
+    }
+
+    // Without exceptions or allocation; on POSIX only async-signal-safe calls
+    // (open, write, close), so the fatal-signal handler can use it too
+    bool writeFile(const char* path, FlightDumpReason reason, std::int32_t code) const {
+#ifdef RIDEEASY_FLIGHT_POSIX
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        bool ok = true;
+        writeDump([fd, &ok](const void* data, std::size_t bytes) {
+            const char* cursor = static_cast<const char*>(data);
+            while (ok && bytes > 0) {
+                ssize_t written = write(fd, cursor, bytes);
+                if (written <= 0) {
+                    ok = false;
+                    return;
+                }
+                cursor += written;
+                bytes -= static_cast<std::size_t>(written);
+            }
+        }, reason, code);
+        close(fd);
+        return ok;
+#else
+        std::FILE* file = std::fopen(path, "wb");
+        if (!file) {
+            return false;
+        }
+        bool ok = true;
+        writeDump([file, &ok](const void* data, std::size_t bytes) {
+            ok = ok && std::fwrite(data, 1, bytes, file) == bytes;
+        }, reason, code);
+        return std::fclose(file) == 0 && ok;
+#endif
+    }
+
+#ifdef RIDEEASY_FLIGHT_POSIX
+    static void onFatalSignal(int signalNumber) {
+        const FlightRecorder& recorder = instance();
+        if (recorder.crashPath[0] != '\0') {
+            recorder.writeFile(recorder.crashPath, FlightDumpReason::FATAL_SIGNAL, signalNumber);
+        }
+        raise(signalNumber); // the handler was reset, so this terminates as before
+    }
+#endif
+
+public:
+    static FlightRecorder& instance() {
+        static FlightRecorder recorder;
+        return recorder;
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // Timestamp source: the CPU cycle counter where available (a few ns),
+    // converted to time with the calibration stored in every dump
+    static std::uint64_t ticks() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+        return __builtin_ia32_rdtsc();
+#else
+        return static_cast<std::uint64_t>(monotonicNs());
+#endif
+    }
+
+    // Ring size per thread (rounded up to a power of two) is fixed by the first start
+    void start(std::uint32_t recordsPerThread = 8192) {
+        std::uint32_t size = 64;
+        while (size < recordsPerThread && size < (1u << 24)) {
+            size <<= 1;
+        }
+        std::uint32_t unset = 0;
+        if (capacity.compare_exchange_strong(unset, size)) {
+            startTicks = ticks();
+            startNs = monotonicNs();
+        }
+        enabled.store(true, std::memory_order_release);
+    }
+
+    void stop() { enabled.store(false, std::memory_order_release); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    // Threads that recorded nothing because all MAX_THREADS rings were in use
+    std::uint64_t getDroppedThreads() const { return droppedThreads.load(std::memory_order_relaxed); }
+
+    void record(FlightEvent event, std::uint16_t code = 0, std::uint32_t subject = 0, std::uint32_t detail = 0,
+                std::int64_t value = 0) {
+        if (!enabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        Ring* ring = threadRing();
+        if (!ring) {
+            return;
+        }
+        std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+        FlightRecord& slot = ring->records[head & (ring->capacity - 1)];
+        slot.ticks = ticks();
+        slot.event = static_cast<std::uint16_t>(event);
+        slot.code = code;
+        slot.subject = subject;
+        slot.detail = detail;
+        slot.value = value;
+        ring->head.store(head + 1, std::memory_order_release);
+    }
+
+    void dump(const std::string& path, FlightDumpReason reason = FlightDumpReason::ON_DEMAND,
+              std::int32_t code = 0) const {
+        if (!writeFile(path.c_str(), reason, code)) {
+            throw std::runtime_error("Cannot write flight recording: " + path);
+        }
+    }
+
+    // Dumps to <path> when the process dies of SIGSEGV, SIGBUS, SIGFPE, SIGILL
+    // or SIGABRT, then lets the signal terminate it as usual. POSIX only.
+    void installCrashHandler(const std::string& path) {
+#ifdef RIDEEASY_FLIGHT_POSIX
+        copyPath(crashPath, sizeof(crashPath), path);
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &FlightRecorder::onFatalSignal;
+        action.sa_flags = SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        for (int signalNumber : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+            sigaction(signalNumber, &action, nullptr);
+        }
+#else
+        (void)path;
+        throw std::runtime_error("Crash dumps need POSIX signals");
+#endif
+    }
+
+    // Anomalies dump to <prefix>-<n>.bin, at most once per interval
+    void setAnomalyDump(const std::string& prefix, std::int64_t minIntervalMs = 10000) {
+        copyPath(anomalyPrefix, sizeof(anomalyPrefix) - 16, prefix);
+        anomalyIntervalNs = minIntervalMs * 1000000;
+    }
+
+    // Records the anomaly and, if configured and not rate-limited, dumps.
+    // Returns the dump path, or "" when nothing was written; never throws.
+    std::string triggerAnomaly(FlightAnomaly kind, std::uint32_t subject = 0, std::int64_t value = 0) {
+        if (!isEnabled()) {
+            return "";
+        }
+        record(FlightEvent::ANOMALY, static_cast<std::uint16_t>(kind), subject, 0, value);
+        if (anomalyPrefix[0] == '\0') {
+            return "";
+        }
+        std::int64_t now = monotonicNs();
+        std::int64_t last = lastAnomalyDumpNs.load(std::memory_order_relaxed);
+        if ((last != 0 && now - last < anomalyIntervalNs) ||
+            !lastAnomalyDumpNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+            return "";
+        }
+        std::string path = std::string(anomalyPrefix) + "-" + std::to_string(anomalyDumps.fetch_add(1) + 1) + ".bin";
+        return writeFile(path.c_str(), FlightDumpReason::ANOMALY, static_cast<std::int32_t>(kind)) ? path : "";
+    }
+};
+
+#endif
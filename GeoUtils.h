@@ -0,0 +1,50 @@
+#ifndef GEO_UTILS_H
+#define GEO_UTILS_H
+
+#include "User.h"
+#include <cmath>
+#include <cstdint>
+
+// Shared spatial helpers (planar approximation, good enough at city scale)
+class GeoUtils {
+public:
+    static constexpr double KM_PER_DEGREE = 111.0; // 1 degree ≈ 111 km
+
+    static double distanceKm(const Location& from, const Location& to) {
+        double latDiff = from.latitude - to.latitude;
+        double lngDiff = from.longitude - to.longitude;
+        return std::sqrt(latDiff * latDiff + lngDiff * lngDiff) * KM_PER_DEGREE;
+    }
+
+    // Works on the integer micro-degree values directly; differences are taken in
+    // double so the full coordinate range cannot overflow
+    static double distanceKm(const GeoPoint& from, const GeoPoint& to) {
+        double latDiff = static_cast<double>(from.latitudeE6) - to.latitudeE6;
+        double lngDiff = static_cast<double>(from.longitudeE6) - to.longitudeE6;
+        return std::sqrt(latDiff * latDiff + lngDiff * lngDiff) * (KM_PER_DEGREE / GeoPoint::UNITS_PER_DEGREE);
+    }
+
+    static GeoPoint toPoint(const Location& location) {
+        return GeoPoint::fromDegrees(location.latitude, location.longitude);
+    }
+
+    static Location toLocation(const GeoPoint& point) {
+        return Location(point.latitude(), point.longitude());
+    }
+
+    // Grid cell coordinate along one axis (micro-degrees) for the given cell size
+    static int cellCoordinate(std::int32_t unitsE6, double cellSizeDegrees) {
+        return static_cast<int>(std::floor(unitsE6 / (cellSizeDegrees * GeoPoint::UNITS_PER_DEGREE)));
+    }
+
+    // Direction of travel quantized into bucketCount sectors (0 = due west, counter-clockwise)
+    static int headingBucket(const GeoPoint& from, const GeoPoint& to, int bucketCount) {
+        const double pi = 3.14159265358979323846;
+        double angle = std::atan2(static_cast<double>(to.latitudeE6) - from.latitudeE6,
+                                  static_cast<double>(to.longitudeE6) - from.longitudeE6);
+        int bucket = static_cast<int>((angle + pi) / (2.0 * pi) * bucketCount);
+        return bucket % bucketCount;
+    }
+};
+
+#endif
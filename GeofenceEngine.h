@@ -0,0 +1,327 @@
+#ifndef GEOFENCE_ENGINE_H
+#define GEOFENCE_ENGINE_H
+
+#include "User.h"
+#include "GeoUtils.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+using ZoneId = std::uint32_t;
+
+enum class GeofenceType {
+    AIRPORT_PICKUP,  // pickups here are served from the airport's driver queue
+    NO_PICKUP,       // ride requests starting here are rejected
+    SPECIAL_PRICING  // fares of rides starting here are multiplied
+};
+
+struct Geofence {
+    std::string name;
+    GeofenceType type;
+    double pricingMultiplier = 1.0; // used by SPECIAL_PRICING zones
+    std::vector<GeoPoint> vertices; // simple polygon, implicitly closed
+};
+
+// Every zone containing one point, summarized
+struct GeofenceStatus {
+    ZoneId zoneId = 0xFFFFFFFFu;        // first containing zone in load order
+    ZoneId airportZoneId = 0xFFFFFFFFu; // containing airport pickup zone, if any
+    bool noPickup = false;
+    double pricingMultiplier = 1.0;     // product over containing special pricing zones
+};
+
+// Polygon geofences rasterized into grid cells at load time. Each covered cell
+// lists the zones that touch it, marked interior (the whole cell is inside, no
+// test needed) or boundary (an edge crosses the cell, so the exact
+// point-in-polygon test runs). A query is one hash lookup plus exact tests for
+// the few boundary zones of that cell. Loaded zone sets are immutable and
+// shared: every thread caches a reference to the set it last used, tagged with
+// its generation, so a query is one acquire load of the current generation and
+// takes the writer lock only to pick up a newly published set. A replaced set
+// is freed once no thread's cache still holds it.
+//
+// File format: blocks of
+//     zone <AIRPORT_PICKUP|NO_PICKUP|SPECIAL_PRICING> <multiplier> <name...>
+//     <latitude> <longitude>     (one line per vertex, at least three)
+//     end
+// Blank lines and lines starting with '#' are ignored.
+class GeofenceEngine {
+public:
+    static constexpr ZoneId NO_ZONE = 0xFFFFFFFFu;
+
+private:
+    struct CellEntry {
+        ZoneId zone;
+        bool interior;
+    };
+
+    struct CompiledZones {
+        std::vector<Geofence> zones;
+        std::unordered_map<std::uint64_t, std::vector<CellEntry>> cells;
+        double cellSizeDegrees = 0.005;
+        std::size_t interiorCells = 0;
+        std::size_t boundaryCells = 0;
+    };
+
+    // A thread's most recently used set
+    struct CachedZones {
+        std::uint64_t generation = 0;
+        std::shared_ptr<const CompiledZones> zones;
+    };
+
+    double cellSizeDegrees;
+    std::shared_ptr<const CompiledZones> compiled; // guarded by writerMutex
+    std::atomic<std::uint64_t> generation{0};      // of compiled; unique across engines
+    mutable std::mutex writerMutex;                // serializes setZones; queries take it on a generation change
+
+    static std::atomic<std::uint64_t>& generationCounter() {
+        static std::atomic<std::uint64_t> counter{0};
+        return counter;
+    }
+
+    static std::uint64_t cellKey(int latCell, int lngCell) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(latCell)) << 32) |
+               static_cast<std::uint32_t>(lngCell);
+    }
+
+    // Ray casting on the micro-degree values
+    static bool containsPoint(const std::vector<GeoPoint>& vertices, double latitudeE6, double longitudeE6) {
+        bool inside = false;
+        for (std::size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++) {
+            double latI = vertices[i].latitudeE6, lngI = vertices[i].longitudeE6;
+            double latJ = vertices[j].latitudeE6, lngJ = vertices[j].longitudeE6;
+            if ((latI > latitudeE6) != (latJ > latitudeE6) &&
+                longitudeE6 < (lngJ - lngI) * (latitudeE6 - latI) / (latJ - latI) + lngI) {
+                inside = !inside;
+            }
+        }
+        return inside;
+    }
+
+    // Separating-axis test: the segment touches the rectangle unless their bounding
+    // boxes are disjoint or all four corners lie strictly on one side of its line
+    static bool segmentTouchesCell(const GeoPoint& a, const GeoPoint& b,
+                                   double minLat, double minLng, double maxLat, double maxLng) {
+        if (std::max(a.latitudeE6, b.latitudeE6) < minLat || std::min(a.latitudeE6, b.latitudeE6) > maxLat ||
+            std::max(a.longitudeE6, b.longitudeE6) < minLng || std::min(a.longitudeE6, b.longitudeE6) > maxLng) {
+            return false;
+        }
+        double dLat = static_cast<double>(b.latitudeE6) - a.latitudeE6;
+        double dLng = static_cast<double>(b.longitudeE6) - a.longitudeE6;
+        auto side = [&](double lat, double lng) {
+            return dLat * (lng - a.longitudeE6) - dLng * (lat - a.latitudeE6);
+        };
+        double corners[4] = {side(minLat, minLng), side(minLat, maxLng), side(maxLat, minLng), side(maxLat, maxLng)};
+        bool allPositive = true;
+        bool allNegative = true;
+        for (double corner : corners) {
+            allPositive = allPositive && corner > 0;
+            allNegative = allNegative && corner < 0;
+        }
+        return !allPositive && !allNegative;
+    }
+
+    static void rasterize(CompiledZones& result, ZoneId zoneId) {
+        const Geofence& zone = result.zones[zoneId];
+        double cellUnits = result.cellSizeDegrees * GeoPoint::UNITS_PER_DEGREE;
+
+        std::int32_t minLat = zone.vertices[0].latitudeE6, maxLat = minLat;
+        std::int32_t minLng = zone.vertices[0].longitudeE6, maxLng = minLng;
+        for (const auto& vertex : zone.vertices) {
+            minLat = std::min(minLat, vertex.latitudeE6);
+            maxLat = std::max(maxLat, vertex.latitudeE6);
+            minLng = std::min(minLng, vertex.longitudeE6);
+            maxLng = std::max(maxLng, vertex.longitudeE6);
+        }
+        int firstLatCell = GeoUtils::cellCoordinate(minLat, result.cellSizeDegrees);
+        int lastLatCell = GeoUtils::cellCoordinate(maxLat, result.cellSizeDegrees);
+        int firstLngCell = GeoUtils::cellCoordinate(minLng, result.cellSizeDegrees);
+        int lastLngCell = GeoUtils::cellCoordinate(maxLng, result.cellSizeDegrees);
+
+        for (int latCell = firstLatCell; latCell <= lastLatCell; latCell++) {
+            for (int lngCell = firstLngCell; lngCell <= lastLngCell; lngCell++) {
+                double cellMinLat = latCell * cellUnits, cellMaxLat = cellMinLat + cellUnits;
+                double cellMinLng = lngCell * cellUnits, cellMaxLng = cellMinLng + cellUnits;
+
+                bool boundary = false;
+                for (std::size_t i = 0, j = zone.vertices.size() - 1; i < zone.vertices.size() && !boundary; j = i++) {
+                    boundary = segmentTouchesCell(zone.vertices[j], zone.vertices[i],
+                                                  cellMinLat, cellMinLng, cellMaxLat, cellMaxLng);
+                }
+                // No edge crosses the cell, so its centre decides for the whole cell
+                if (!boundary && !containsPoint(zone.vertices, cellMinLat + cellUnits / 2, cellMinLng + cellUnits / 2)) {
+                    continue;
+                }
+
+                result.cells[cellKey(latCell, lngCell)].push_back({zoneId, !boundary});
+                (boundary ? result.boundaryCells : result.interiorCells)++;
+            }
+        }
+    }
+
+    // Valid until this thread's next call, on this engine or another one
+    const CompiledZones& current() const {
+        static thread_local CachedZones cache;
+        if (cache.generation != generation.load(std::memory_order_acquire)) {
+            std::shared_ptr<const CompiledZones> latest;
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                latest = compiled;
+                cache.generation = generation.load(std::memory_order_relaxed);
+            }
+            cache.zones.swap(latest); // the set it replaces may be freed here, outside the lock
+        }
+        return *cache.zones;
+    }
+
+    void publish(std::unique_ptr<const CompiledZones> zones) {
+        std::shared_ptr<const CompiledZones> replaced(std::move(zones));
+        std::lock_guard<std::mutex> lock(writerMutex);
+        compiled.swap(replaced);
+        generation.store(generationCounter().fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    static GeofenceType parseType(const std::string& name, int lineNumber) {
+        if (name == "AIRPORT_PICKUP") return GeofenceType::AIRPORT_PICKUP;
+        if (name == "NO_PICKUP") return GeofenceType::NO_PICKUP;
+        if (name == "SPECIAL_PRICING") return GeofenceType::SPECIAL_PRICING;
+        throw std::runtime_error("Geofence line " + std::to_string(lineNumber) + ": unknown zone type " + name);
+    }
+
+public:
+    GeofenceEngine(double cellSizeDegrees = 0.005)
+        : cellSizeDegrees(cellSizeDegrees) {
+        publish(std::make_unique<CompiledZones>());
+    }
+
+    // Validates, rasterizes and publishes a new zone set; zone IDs are indexes into it
+    void setZones(std::vector<Geofence> zones) {
+        auto result = std::make_unique<CompiledZones>();
+        result->cellSizeDegrees = cellSizeDegrees;
+        result->zones = std::move(zones);
+        for (ZoneId id = 0; id < result->zones.size(); id++) {
+            const Geofence& zone = result->zones[id];
+            if (zone.vertices.size() < 3) {
+                throw std::invalid_argument("Geofence " + zone.name + " needs at least three vertices");
+            }
+            if (zone.pricingMultiplier <= 0.0) {
+                throw std::invalid_argument("Geofence " + zone.name + " has a non-positive pricing multiplier");
+            }
+            rasterize(*result, id);
+        }
+        publish(std::move(result));
+    }
+
+    void load(std::istream& input) {
+        std::vector<Geofence> zones;
+        bool inZone = false;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(input, line)) {
+            lineNumber++;
+            std::istringstream fields(line);
+            std::string first;
+            if (!(fields >> first) || first[0] == '#') {
+                continue;
+            }
+
+            if (first == "zone") {
+                if (inZone) {
+                    throw std::runtime_error("Geofence line " + std::to_string(lineNumber) + ": missing 'end'");
+                }
+                std::string typeName;
+                Geofence zone;
+                if (!(fields >> typeName >> zone.pricingMultiplier)) {
+                    throw std::runtime_error("Geofence line " + std::to_string(lineNumber) +
+                                             ": expected 'zone <type> <multiplier> <name>'");
+                }
+                zone.type = parseType(typeName, lineNumber);
+                std::getline(fields >> std::ws, zone.name);
+                zones.push_back(std::move(zone));
+                inZone = true;
+            } else if (first == "end") {
+                if (!inZone) {
+                    throw std::runtime_error("Geofence line " + std::to_string(lineNumber) + ": 'end' outside a zone");
+                }
+                inZone = false;
+            } else {
+                double latitude = 0.0;
+                double longitude = 0.0;
+                std::istringstream vertex(line);
+                if (!inZone || !(vertex >> latitude >> longitude)) {
+                    throw std::runtime_error("Geofence line " + std::to_string(lineNumber) + ": unexpected '" +
+                                             line + "'");
+                }
+                zones.back().vertices.push_back(GeoPoint::fromDegrees(latitude, longitude));
+            }
+        }
+        if (inZone) {
+            throw std::runtime_error("Geofence file ends inside a zone");
+        }
+        setZones(std::move(zones));
+    }
+
+    void loadFromFile(const std::string& path) {
+        std::ifstream input(path);
+        if (!input) {
+            throw std::runtime_error("Cannot open geofence file: " + path);
+        }
+        load(input);
+    }
+
+    GeofenceStatus query(const GeoPoint& point) const {
+        GeofenceStatus status;
+        const CompiledZones& zones = current();
+        if (zones.cells.empty()) {
+            return status;
+        }
+        auto cell = zones.cells.find(cellKey(GeoUtils::cellCoordinate(point.latitudeE6, zones.cellSizeDegrees),
+                                             GeoUtils::cellCoordinate(point.longitudeE6, zones.cellSizeDegrees)));
+        if (cell == zones.cells.end()) {
+            return status;
+        }
+
+        for (const auto& entry : cell->second) {
+            const Geofence& zone = zones.zones[entry.zone];
+            if (!entry.interior && !containsPoint(zone.vertices, point.latitudeE6, point.longitudeE6)) {
+                continue;
+            }
+            if (status.zoneId == NO_ZONE) {
+                status.zoneId = entry.zone;
+            }
+            switch (zone.type) {
+                case GeofenceType::AIRPORT_PICKUP:
+                    if (status.airportZoneId == NO_ZONE) {
+                        status.airportZoneId = entry.zone;
+                    }
+                    break;
+                case GeofenceType::NO_PICKUP:
+                    status.noPickup = true;
+                    break;
+                case GeofenceType::SPECIAL_PRICING:
+                    status.pricingMultiplier *= zone.pricingMultiplier;
+                    break;
+            }
+        }
+        return status;
+    }
+
+    std::string getZoneName(ZoneId id) const {
+        const CompiledZones& zones = current();
+        return id < zones.zones.size() ? zones.zones[id].name : std::string();
+    }
+
+    std::size_t getZoneCount() const { return current().zones.size(); }
+    std::size_t getInteriorCellCount() const { return current().interiorCells; }
+    std::size_t getBoundaryCellCount() const { return current().boundaryCells; }
+};
+
+#endif
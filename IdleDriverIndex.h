@@ -0,0 +1,147 @@
+#ifndef IDLE_DRIVER_INDEX_H
+#define IDLE_DRIVER_INDEX_H
+
+#include "User.h"
+#include "GeoUtils.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Idle drivers bucketed by (grid cell, vehicle type), by dense driver ID.
+// Dispatch probes square rings of cells around the pickup, nearest ring
+// first, so a request only looks at drivers in its own neighbourhood instead
+// of scanning the fleet. Cells follow each driver's last GPS fix.
+class IdleDriverIndex {
+private:
+    static constexpr std::uint64_t NOT_INDEXED = ~0ull;
+
+    double cellSizeDegrees;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells; // key -> dense driver IDs
+    std::vector<std::uint64_t> slotKeys;    // current key per dense driver ID, NOT_INDEXED if absent
+    std::vector<std::uint32_t> slotOffsets; // index inside its cell's vector
+    std::vector<std::uint16_t> slotTypes;
+
+    static std::uint64_t makeKey(int latCell, int lngCell, std::uint16_t vehicleType) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(latCell)) << 32) |
+               ((static_cast<std::uint64_t>(static_cast<std::uint32_t>(lngCell)) & 0xFFFFFF) << 8) |
+               static_cast<std::uint64_t>(vehicleType & 0xFF);
+    }
+
+    std::uint64_t keyFor(const GeoPoint& position, std::uint16_t vehicleType) const {
+        return makeKey(GeoUtils::cellCoordinate(position.latitudeE6, cellSizeDegrees),
+                       GeoUtils::cellCoordinate(position.longitudeE6, cellSizeDegrees), vehicleType);
+    }
+
+    void unlink(std::uint32_t slot) {
+        auto cell = cells.find(slotKeys[slot]);
+        auto& members = cell->second;
+        std::uint32_t moved = members.back();
+        members[slotOffsets[slot]] = moved;
+        slotOffsets[moved] = slotOffsets[slot];
+        members.pop_back();
+        if (members.empty()) {
+            cells.erase(cell);
+        }
+        slotKeys[slot] = NOT_INDEXED;
+    }
+
+    void link(std::uint32_t slot, std::uint64_t key) {
+        auto& members = cells[key];
+        slotOffsets[slot] = static_cast<std::uint32_t>(members.size());
+        members.push_back(slot);
+        slotKeys[slot] = key;
+    }
+
+public:
+    explicit IdleDriverIndex(double cellSizeDegrees = 0.01) : cellSizeDegrees(cellSizeDegrees) {}
+
+    // Adds the driver, or moves it if already indexed
+    void insert(std::uint32_t slot, std::uint16_t vehicleType, const GeoPoint& position) {
+        if (slot >= slotKeys.size()) {
+            slotKeys.resize(slot + 1, NOT_INDEXED);
+            slotOffsets.resize(slot + 1, 0);
+            slotTypes.resize(slot + 1, 0);
+        }
+        std::uint64_t key = keyFor(position, vehicleType);
+        if (slotKeys[slot] == key) {
+            return;
+        }
+        if (slotKeys[slot] != NOT_INDEXED) {
+            unlink(slot);
+        }
+        slotTypes[slot] = vehicleType;
+        link(slot, key);
+    }
+
+    // Re-buckets an indexed driver after it moved; others are ignored
+    void update(std::uint32_t slot, const GeoPoint& position) {
+        if (slot < slotKeys.size() && slotKeys[slot] != NOT_INDEXED) {
+            insert(slot, slotTypes[slot], position);
+        }
+    }
+
+    void remove(std::uint32_t slot) {
+        if (slot < slotKeys.size() && slotKeys[slot] != NOT_INDEXED) {
+            unlink(slot);
+        }
+    }
+
+    bool contains(std::uint32_t slot) const {
+        return slot < slotKeys.size() && slotKeys[slot] != NOT_INDEXED;
+    }
+
+    // Rings needed to cover radiusKm around a point (cells are narrowest along longitude)
+    int ringsFor(const GeoPoint& centre, double radiusKm) const {
+        const double pi = 3.14159265358979323846;
+        double cellKm = cellSizeDegrees * 111.0 * std::max(0.1, std::cos(centre.latitude() * pi / 180.0));
+        return static_cast<int>(std::ceil(radiusKm / cellKm));
+    }
+
+    // Visits the drivers of one vehicle type in the cells exactly `ring` cells
+    // (Chebyshev distance) from the centre's cell; returns the cells probed
+    template <typename Visit>
+    std::size_t forEachInRing(std::uint16_t vehicleType, const GeoPoint& centre, int ring, Visit&& visit) const {
+        if (cells.empty()) {
+            return 0;
+        }
+        int latCell = GeoUtils::cellCoordinate(centre.latitudeE6, cellSizeDegrees);
+        int lngCell = GeoUtils::cellCoordinate(centre.longitudeE6, cellSizeDegrees);
+        std::size_t probed = 0;
+        auto probe = [&](int dLat, int dLng) {
+            probed++;
+            auto cell = cells.find(makeKey(latCell + dLat, lngCell + dLng, vehicleType));
+            if (cell != cells.end()) {
+                for (std::uint32_t slot : cell->second) {
+                    visit(slot);
+                }
+            }
+        };
+        if (ring == 0) {
+            probe(0, 0);
+            return probed;
+        }
+        for (int d = -ring; d <= ring; d++) {
+            probe(-ring, d);
+            probe(ring, d);
+        }
+        for (int d = -ring + 1; d < ring; d++) {
+            probe(d, -ring);
+            probe(d, ring);
+        }
+        return probed;
+    }
+
+    void clear() {
+        cells.clear();
+        std::fill(slotKeys.begin(), slotKeys.end(), NOT_INDEXED);
+    }
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(
+            std::count_if(slotKeys.begin(), slotKeys.end(), [](std::uint64_t key) { return key != NOT_INDEXED; }));
+    }
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// Log-linear (HDR-style) bucketing of nanosecond values: every power of two
+// is split into 64 linear sub-buckets, so any recorded value is reported
+// within 1.6% while the whole range up to 2^40 ns (about 18 minutes) needs
+// only 2304 counters.
+struct LatencyBuckets {
+    static constexpr int SUB_BUCKET_BITS = 6;
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr std::size_t COUNT = static_cast<std::size_t>(MAX_EXPONENT - SUB_BUCKET_BITS + 2)
+                                         << SUB_BUCKET_BITS;
+
+    static std::size_t index(std::uint64_t value) {
+        constexpr std::uint64_t maxValue = (1ull << MAX_EXPONENT) - 1;
+        value = std::min(value, maxValue);
+        if (value < (1ull << SUB_BUCKET_BITS)) {
+            return static_cast<std::size_t>(value);
+        }
+        int exponent = 63 - countLeadingZeros(value);
+        int shift = exponent - SUB_BUCKET_BITS;
+        return (static_cast<std::size_t>(shift + 1) << SUB_BUCKET_BITS) +
+               static_cast<std::size_t>((value >> shift) - (1ull << SUB_BUCKET_BITS));
+    }
+
+    // Largest value that maps to the bucket
+    static std::uint64_t upperBound(std::size_t bucket) {
+        if (bucket < (1u << SUB_BUCKET_BITS)) {
+            return bucket;
+        }
+        int shift = static_cast<int>(bucket >> SUB_BUCKET_BITS) - 1;
+        std::uint64_t sub = (bucket & ((1u << SUB_BUCKET_BITS) - 1)) + (1ull << SUB_BUCKET_BITS);
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+    static int countLeadingZeros(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int zeros = 0;
+        for (std::uint64_t bit = 1ull << 63; !(value & bit); bit >>= 1) {
+            zeros++;
+        }
+        return zeros;
+#endif
+    }
+};
+
+// Small per-thread number, assigned on first use; sharded structures take it
+// modulo their shard count so threads spread over the shards
+inline std::size_t threadShardIndex() {
+    static std::atomic<std::size_t> nextThread{0};
+    thread_local std::size_t index = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+struct LatencySummary {
+    std::uint64_t count = 0;
+    double meanNs = 0.0;
+    std::uint64_t p50Ns = 0;
+    std::uint64_t p99Ns = 0;
+    std::uint64_t p999Ns = 0;
+    std::uint64_t maxNs = 0;
+};
+
+// Plain (single-threaded) histogram, used for merged snapshots
+class LatencyHistogram {
+private:
+    std::array<std::uint64_t, LatencyBuckets::COUNT> counts{};
+    std::uint64_t total = 0;
+    std::uint64_t sumNs = 0;
+    std::uint64_t maxNs = 0;
+
+public:
+    void record(std::uint64_t valueNs) {
+        counts[LatencyBuckets::index(valueNs)]++;
+        total++;
+        sumNs += valueNs;
+        maxNs = std::max(maxNs, valueNs);
+    }
+
+    void addBucket(std::size_t bucket, std::uint64_t count) {
+        counts[bucket] += count;
+        total += count;
+    }
+
+    void addTotals(std::uint64_t sum, std::uint64_t max) {
+        sumNs += sum;
+        maxNs = std::max(maxNs, max);
+    }
+
+    std::uint64_t getCount() const { return total; }
+    std::uint64_t getMax() const { return maxNs; }
+    double getMean() const { return total > 0 ? static_cast<double>(sumNs) / total : 0.0; }
+    std::uint64_t getSum() const { return sumNs; }
+
+    // Values recorded in buckets that lie entirely at or below the bound
+    std::uint64_t countAtOrBelow(std::uint64_t boundNs) const {
+        std::uint64_t count = 0;
+        for (std::size_t bucket = 0; bucket < counts.size() && LatencyBuckets::upperBound(bucket) <= boundNs; bucket++) {
+            count += counts[bucket];
+        }
+        return count;
+    }
+
+    // Upper bound of the bucket holding the given percentile (0..100), capped at the exact max
+    std::uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(p / 100.0 * total);
+        rank = std::min(std::max<std::uint64_t>(rank, 1), total);
+        std::uint64_t seen = 0;
+        for (std::size_t bucket = 0; bucket < counts.size(); bucket++) {
+            seen += counts[bucket];
+            if (seen >= rank) {
+                return std::min(LatencyBuckets::upperBound(bucket), maxNs);
+            }
+        }
+        return maxNs;
+    }
+
+    LatencySummary summarize() const {
+        LatencySummary summary;
+        summary.count = total;
+        summary.meanNs = getMean();
+        summary.p50Ns = percentile(50.0);
+        summary.p99Ns = percentile(99.0);
+        summary.p999Ns = percentile(99.9);
+        summary.maxNs = maxNs;
+        return summary;
+    }
+};
+
+// Histograms for several operations, recorded concurrently. Threads write to
+// one of a fixed number of shards (picked once per thread), allocated on first
+// use, with relaxed atomic increments; readers merge all shards with relaxed
+// loads. Nothing takes a lock, so recording never waits for a snapshot. A
+// snapshot taken during recording may split a value from its totals, which
+// is harmless for monitoring.
+template <std::size_t OPERATIONS>
+class ShardedLatencyRecorder {
+public:
+    static constexpr std::size_t SHARDS = 16;
+
+private:
+    struct OperationCounters {
+        std::array<std::atomic<std::uint64_t>, LatencyBuckets::COUNT> counts;
+        std::atomic<std::uint64_t> sumNs{0};
+        std::atomic<std::uint64_t> maxNs{0};
+
+        OperationCounters() {
+            for (auto& count : counts) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct Shard {
+        std::array<OperationCounters, OPERATIONS> operations;
+    };
+
+    std::array<std::atomic<Shard*>, SHARDS> shards{};
+
+    Shard& shardForThread() {
+        std::atomic<Shard*>& slot = shards[threadShardIndex() % SHARDS];
+        Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) {
+            auto created = std::make_unique<Shard>();
+            if (slot.compare_exchange_strong(shard, created.get(), std::memory_order_acq_rel)) {
+                shard = created.release();
+            } // otherwise another thread won and `shard` now holds its pointer
+        }
+        return *shard;
+    }
+
+public:
+    ShardedLatencyRecorder() = default;
+    ShardedLatencyRecorder(const ShardedLatencyRecorder&) = delete;
+    ShardedLatencyRecorder& operator=(const ShardedLatencyRecorder&) = delete;
+
+    ~ShardedLatencyRecorder() {
+        for (auto& slot : shards) {
+            delete slot.load(std::memory_order_acquire);
+        }
+    }
+
+    void record(std::size_t operation, std::uint64_t valueNs) {
+        OperationCounters& counters = shardForThread().operations[operation];
+        counters.counts[LatencyBuckets::index(valueNs)].fetch_add(1, std::memory_order_relaxed);
+        counters.sumNs.fetch_add(valueNs, std::memory_order_relaxed);
+        std::uint64_t max = counters.maxNs.load(std::memory_order_relaxed);
+        while (valueNs > max && !counters.maxNs.compare_exchange_weak(max, valueNs, std::memory_order_relaxed)) {
+        }
+    }
+
+    LatencyHistogram snapshot(std::size_t operation) const {
+        LatencyHistogram merged;
+        for (const auto& slot : shards) {
+            const Shard* shard = slot.load(std::memory_order_acquire);
+            if (!shard) {
+                continue;
+            }
+            const OperationCounters& counters = shard->operations[operation];
+            for (std::size_t bucket = 0; bucket < LatencyBuckets::COUNT; bucket++) {
+                std::uint64_t count = counters.counts[bucket].load(std::memory_order_relaxed);
+                if (count > 0) {
+                    merged.addBucket(bucket, count);
+                }
+            }
+            merged.addTotals(counters.sumNs.load(std::memory_order_relaxed),
+                             counters.maxNs.load(std::memory_order_relaxed));
+        }
+        return merged;
+    }
+
+    // Zeroes every counter; values recorded concurrently may survive the reset
+    void reset() {
+        for (auto& slot : shards) {
+            Shard* shard = slot.load(std::memory_order_acquire);
+            if (!shard) {
+                continue;
+            }
+            for (auto& counters : shard->operations) {
+                for (auto& count : counters.counts) {
+                    count.store(0, std::memory_order_relaxed);
+                }
+                counters.sumNs.store(0, std::memory_order_relaxed);
+                counters.maxNs.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Records the lifetime of a scope into one operation's histogram
+template <typename Recorder>
+class ScopedLatency {
+private:
+    Recorder& recorder;
+    std::size_t operation;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedLatency(Recorder& recorder, std::size_t operation)
+        : recorder(recorder), operation(operation), start(std::chrono::steady_clock::now()) {}
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+    ~ScopedLatency() {
+        recorder.record(operation, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - start).count()));
+    }
+};
+
+#endif
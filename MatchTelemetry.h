@@ -0,0 +1,159 @@
+#ifndef MATCH_TELEMETRY_H
+#define MATCH_TELEMETRY_H
+
+#include "RideTypes.h"
+#include "GeofenceEngine.h"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+// What one dispatch cost and how good its match was
+struct MatchRecord {
+    VehicleType vehicleType = VehicleType::SEDAN;
+    ZoneId zone = GeofenceEngine::NO_ZONE; // pickup zone
+    RideType rideType = RideType::NORMAL;
+    std::uint32_t slotsScanned = 0;  // dense driver slots examined while collecting candidates
+    std::uint32_t bucketsProbed = 0; // carpool group-index buckets and idle-driver grid cells looked up
+    std::uint32_t candidates = 0;    // drivers handed to matching
+    std::uint32_t attempts = 0;      // offers made, including the accepted one
+    bool assigned = false;
+    double pickupKm = 0.0;           // assigned driver to pickup, when assigned
+    std::int64_t durationNs = 0;     // candidate collection through the acceptance loop
+};
+
+// Rolling aggregate of the records of one (vehicle type, zone) pair
+struct MatchSummary {
+    VehicleType vehicleType = VehicleType::SEDAN;
+    ZoneId zone = GeofenceEngine::NO_ZONE;
+    std::uint64_t requests = 0;
+    std::uint64_t assigned = 0;
+    double meanSlotsScanned = 0.0;
+    double meanBucketsProbed = 0.0;
+    double meanCandidates = 0.0;
+    double meanAttempts = 0.0;
+    double meanPickupKm = 0.0; // over assigned requests
+    double meanDurationUs = 0.0;
+    double maxDurationUs = 0.0;
+
+    double assignRate() const { return requests > 0 ? static_cast<double>(assigned) / requests : 0.0; }
+};
+
+// Per (vehicle type, zone) rolling window of match records, kept as a ring of
+// time slices on the engine clock (so simulations roll on virtual time). A
+// slice is reused once the window has moved past it, so memory stays bounded
+// by the number of active pairs. Not synchronized: the engine records and
+// reads it under its own lock.
+class MatchTelemetry {
+private:
+    struct Slice {
+        std::int64_t epoch = -1; // slice number on the clock (timeMs / sliceMs)
+        std::uint64_t requests = 0;
+        std::uint64_t assigned = 0;
+        std::uint64_t slotsScanned = 0;
+        std::uint64_t bucketsProbed = 0;
+        std::uint64_t candidates = 0;
+        std::uint64_t attempts = 0;
+        double pickupKm = 0.0;
+        std::int64_t durationNs = 0;
+        std::int64_t maxDurationNs = 0;
+    };
+
+    std::int64_t sliceMs;
+    std::size_t sliceCount;
+    std::unordered_map<std::uint64_t, std::vector<Slice>> series; // key: vehicle type << 32 | zone
+
+    static std::uint64_t makeKey(VehicleType vehicleType, ZoneId zone) {
+        return (static_cast<std::uint64_t>(vehicleType) << 32) | zone;
+    }
+
+public:
+    // A window of sliceCount slices of sliceMs each; the oldest slice drops out as time advances
+    explicit MatchTelemetry(std::int64_t windowMs = 300000, std::size_t sliceCount = 10) {
+        configure(windowMs, sliceCount);
+    }
+
+    void configure(std::int64_t windowMs, std::size_t slices) {
+        if (windowMs <= 0 || slices == 0 || windowMs < static_cast<std::int64_t>(slices)) {
+            throw std::invalid_argument("Match telemetry window must be positive and at least 1 ms per slice");
+        }
+        sliceMs = windowMs / static_cast<std::int64_t>(slices);
+        sliceCount = slices;
+        series.clear();
+    }
+
+    std::int64_t getWindowMs() const { return sliceMs * static_cast<std::int64_t>(sliceCount); }
+
+    void record(const MatchRecord& match, std::int64_t nowMs) {
+        std::vector<Slice>& slices = series[makeKey(match.vehicleType, match.zone)];
+        if (slices.empty()) {
+            slices.resize(sliceCount);
+        }
+        std::int64_t epoch = nowMs / sliceMs;
+        Slice& slice = slices[static_cast<std::size_t>(epoch % static_cast<std::int64_t>(sliceCount))];
+        if (slice.epoch != epoch) {
+            slice = Slice();
+            slice.epoch = epoch;
+        }
+        slice.requests++;
+        slice.slotsScanned += match.slotsScanned;
+        slice.bucketsProbed += match.bucketsProbed;
+        slice.candidates += match.candidates;
+        slice.attempts += match.attempts;
+        slice.durationNs += match.durationNs;
+        slice.maxDurationNs = std::max(slice.maxDurationNs, match.durationNs);
+        if (match.assigned) {
+            slice.assigned++;
+            slice.pickupKm += match.pickupKm;
+        }
+    }
+
+    // Pairs with requests inside the window ending now, busiest first
+    std::vector<MatchSummary> summaries(std::int64_t nowMs) const {
+        std::int64_t newest = nowMs / sliceMs;
+        std::int64_t oldest = newest - static_cast<std::int64_t>(sliceCount) + 1;
+        std::vector<MatchSummary> result;
+        for (const auto& entry : series) {
+            MatchSummary summary;
+            summary.vehicleType = static_cast<VehicleType>(entry.first >> 32);
+            summary.zone = static_cast<ZoneId>(entry.first & 0xFFFFFFFFu);
+            Slice total;
+            for (const Slice& slice : entry.second) {
+                if (slice.epoch < oldest || slice.epoch > newest) {
+                    continue;
+                }
+                total.requests += slice.requests;
+                total.assigned += slice.assigned;
+                total.slotsScanned += slice.slotsScanned;
+                total.bucketsProbed += slice.bucketsProbed;
+                total.candidates += slice.candidates;
+                total.attempts += slice.attempts;
+                total.pickupKm += slice.pickupKm;
+                total.durationNs += slice.durationNs;
+                total.maxDurationNs = std::max(total.maxDurationNs, slice.maxDurationNs);
+            }
+            if (total.requests == 0) {
+                continue;
+            }
+            double requests = static_cast<double>(total.requests);
+            summary.requests = total.requests;
+            summary.assigned = total.assigned;
+            summary.meanSlotsScanned = total.slotsScanned / requests;
+            summary.meanBucketsProbed = total.bucketsProbed / requests;
+            summary.meanCandidates = total.candidates / requests;
+            summary.meanAttempts = total.attempts / requests;
+            summary.meanPickupKm = total.assigned > 0 ? total.pickupKm / total.assigned : 0.0;
+            summary.meanDurationUs = total.durationNs / requests / 1000.0;
+            summary.maxDurationUs = total.maxDurationNs / 1000.0;
+            result.push_back(summary);
+        }
+        std::sort(result.begin(), result.end(), [](const MatchSummary& a, const MatchSummary& b) {
+            return a.requests != b.requests ? a.requests > b.requests
+                                            : std::make_pair(a.vehicleType, a.zone) < std::make_pair(b.vehicleType, b.zone);
+        });
+        return result;
+    }
+};
+
+#endif
@@ -17,19 +17,39 @@ public:
         const std::vector<std::shared_ptr<Driver>>& availableDrivers,
         const Location& pickupLocation,
         VehicleType requestedVehicleType) = 0;
+    
+    // Same, with each candidate's latest position from the location pipeline
+    // (positions[i] belongs to availableDrivers[i]). Strategies that ignore
+    // location can rely on this default.
+    virtual std::shared_ptr<Driver> findBestDriver(
+        const std::vector<std::shared_ptr<Driver>>& availableDrivers,
+        const std::vector<GeoPoint>& /*positions*/,
+        const GeoPoint& pickupPoint,
+        VehicleType requestedVehicleType) {
+        Location pickupLocation(pickupPoint.latitude(), pickupPoint.longitude());
+        return findBestDriver(availableDrivers, pickupLocation, requestedVehicleType);
+    }
+    
+    // True if only drivers of the requested vehicle type can ever be chosen, which
+    // lets the engine drop other types before matching
+    virtual bool requiresVehicleTypeMatch() const { return false; }
 };
 
 // Nearest driver strategy
 class NearestDriverStrategy : public MatchingStrategy {
 private:
-    double calculateDistance(const Location& loc1, const Location& loc2) {
-        // Simple Euclidean distance calculation
-        double latDiff = loc1.latitude - loc2.latitude;
-        double lngDiff = loc1.longitude - loc2.longitude;
+    double calculateDistance(const GeoPoint& position, const GeoPoint& pickup) {
+        // Simple Euclidean distance on the quantized coordinates
+        double latDiff = static_cast<double>(position.latitudeE6) - pickup.latitudeE6;
+        double lngDiff = static_cast<double>(position.longitudeE6) - pickup.longitudeE6;
         return std::sqrt(latDiff * latDiff + lngDiff * lngDiff);
     }
 
 public:
+    using MatchingStrategy::findBestDriver;
+    
+    bool requiresVehicleTypeMatch() const override { return true; }
+    
     std::shared_ptr<Driver> findBestDriver(
         const std::vector<std::shared_ptr<Driver>>& availableDrivers,
         const Location& pickupLocation,
@@ -37,6 +57,7 @@ public:
         
         std::shared_ptr<Driver> bestDriver = nullptr;
         double minDistance = std::numeric_limits<double>::max();
+        GeoPoint pickupPoint = GeoPoint::fromDegrees(pickupLocation.latitude, pickupLocation.longitude);
         
         for (const auto& driver : availableDrivers) {
             // Check if driver's vehicle type matches or is compatible
@@ -44,7 +65,7 @@ public:
             std::string requestedType = VehicleTypeFactory::getVehicleTypeName(requestedVehicleType);
             
             if (driverVehicleType == requestedType) {
-                double distance = calculateDistance(driver->getCurrentLocation(), pickupLocation);
+                double distance = calculateDistance(driver->getPosition(), pickupPoint);
                 if (distance < minDistance) {
                     minDistance = distance;
                     bestDriver = driver;
@@ -54,11 +75,38 @@ public:
         
         return bestDriver;
     }
+    
+    std::shared_ptr<Driver> findBestDriver(
+        const std::vector<std::shared_ptr<Driver>>& availableDrivers,
+        const std::vector<GeoPoint>& positions,
+        const GeoPoint& pickupPoint,
+        VehicleType requestedVehicleType) override {
+        
+        std::shared_ptr<Driver> bestDriver = nullptr;
+        double minDistance = std::numeric_limits<double>::max();
+        std::string requestedType = VehicleTypeFactory::getVehicleTypeName(requestedVehicleType);
+        
+        for (std::size_t i = 0; i < availableDrivers.size(); i++) {
+            if (availableDrivers[i]->getVehicle().vehicleType == requestedType) {
+                double distance = calculateDistance(positions[i], pickupPoint);
+                if (distance < minDistance) {
+                    minDistance = distance;
+                    bestDriver = availableDrivers[i];
+                }
+            }
+        }
+        
+        return bestDriver;
+    }
 };
 
 // Best rated driver strategy
 class BestRatedDriverStrategy : public MatchingStrategy {
 public:
+    using MatchingStrategy::findBestDriver;
+    
+    bool requiresVehicleTypeMatch() const override { return true; }
+    
     std::shared_ptr<Driver> findBestDriver(
         const std::vector<std::shared_ptr<Driver>>& availableDrivers,
         const Location& /*pickupLocation*/,
@@ -0,0 +1,221 @@
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include "LatencyHistogram.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <ostream>
+#include <iomanip>
+#include <limits>
+#include <cstdio>
+#include <cstdint>
+#include <stdexcept>
+
+// Monotonic counter. Each thread adds to its own cache line (one of a fixed
+// number of shards), so hot-path updates never contend; reads sum the shards.
+class MetricCounter {
+public:
+    static constexpr std::size_t SHARDS = 16;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+    Shard shards[SHARDS];
+
+public:
+    void add(std::uint64_t amount = 1) {
+        shards[threadShardIndex() % SHARDS].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    std::uint64_t value() const {
+        std::uint64_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+};
+
+// Value that goes up and down (set, or adjusted by +/-)
+class MetricGauge {
+private:
+    std::atomic<std::int64_t> current{0};
+
+public:
+    void set(std::int64_t value) { current.store(value, std::memory_order_relaxed); }
+    void add(std::int64_t amount) { current.fetch_add(amount, std::memory_order_relaxed); }
+    std::int64_t value() const { return current.load(std::memory_order_relaxed); }
+};
+
+// Named metrics rendered in the Prometheus text exposition format (0.0.4).
+// Registration takes a lock; updates only touch the metric's own atomics, and
+// rendering reads them with relaxed loads, so a scrape never waits for (or
+// holds up) the code being measured. Gauges and histograms can also be
+// computed at scrape time from a callback.
+class MetricsRegistry {
+public:
+    using GaugeFunction = std::function<double()>;
+    using HistogramFunction = std::function<LatencyHistogram()>; // nanoseconds, rendered in seconds
+
+private:
+    struct Series {
+        std::string name;
+        std::string help;
+        std::string type;   // counter, gauge or histogram
+        std::string labels; // e.g. type="normal", without braces
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        GaugeFunction gaugeFunction;
+        HistogramFunction histogramFunction;
+    };
+
+    std::vector<std::unique_ptr<Series>> series;
+    std::vector<double> histogramBoundsSeconds;
+    mutable std::mutex seriesMutex;
+
+    Series& add(const std::string& name, const std::string& help, const std::string& type,
+                const std::string& labels) {
+        std::lock_guard<std::mutex> lock(seriesMutex);
+        for (const auto& existing : series) {
+            if (existing->name == name && existing->type != type) {
+                throw std::invalid_argument("Metric " + name + " already registered as a " + existing->type);
+            }
+            if (existing->name == name && existing->labels == labels) {
+                throw std::invalid_argument("Metric " + name + "{" + labels + "} already registered");
+            }
+        }
+        series.push_back(std::make_unique<Series>());
+        Series& added = *series.back();
+        added.name = name;
+        added.help = help;
+        added.type = type;
+        added.labels = labels;
+        return added;
+    }
+
+    static std::string braces(const std::string& labels, const std::string& extra = "") {
+        std::string joined = labels.empty() ? extra : (extra.empty() ? labels : labels + "," + extra);
+        return joined.empty() ? "" : "{" + joined + "}";
+    }
+
+    static void writeValue(std::ostream& output, double value) {
+        if (value == std::numeric_limits<double>::infinity()) {
+            output << "+Inf";
+        } else {
+            output << value;
+        }
+    }
+
+    void renderHistogram(std::ostream& output, const Series& metric) const {
+        LatencyHistogram histogram = metric.histogramFunction();
+        for (double bound : histogramBoundsSeconds) {
+            std::ostringstream le;
+            le << "le=\"" << bound << "\"";
+            output << metric.name << "_bucket" << braces(metric.labels, le.str()) << ' '
+                   << histogram.countAtOrBelow(static_cast<std::uint64_t>(bound * 1e9)) << '\n';
+        }
+        output << metric.name << "_bucket" << braces(metric.labels, "le=\"+Inf\"") << ' ' << histogram.getCount()
+               << '\n';
+        output << metric.name << "_sum" << braces(metric.labels) << ' ' << histogram.getSum() / 1e9 << '\n';
+        output << metric.name << "_count" << braces(metric.labels) << ' ' << histogram.getCount() << '\n';
+    }
+
+public:
+    // Bucket bounds (seconds) of every histogram; values are bucketed at HDR
+    // precision, so a bound counts the values whose bucket lies below it
+    MetricsRegistry()
+        : histogramBoundsSeconds{0.000005, 0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005,
+                                 0.001,    0.0025,  0.005,    0.01,    0.025,  0.05,    0.1} {}
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    MetricCounter& counter(const std::string& name, const std::string& help, const std::string& labels = "") {
+        Series& metric = add(name, help, "counter", labels);
+        metric.counter = std::make_unique<MetricCounter>();
+        return *metric.counter;
+    }
+
+    MetricGauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "") {
+        Series& metric = add(name, help, "gauge", labels);
+        metric.gauge = std::make_unique<MetricGauge>();
+        return *metric.gauge;
+    }
+
+    void gaugeFunction(const std::string& name, const std::string& help, const std::string& labels,
+                       GaugeFunction function) {
+        add(name, help, "gauge", labels).gaugeFunction = std::move(function);
+    }
+
+    void histogramFunction(const std::string& name, const std::string& help, const std::string& labels,
+                           HistogramFunction function) {
+        add(name, help, "histogram", labels).histogramFunction = std::move(function);
+    }
+
+    // Series of one name are written together under a single HELP/TYPE header
+    void render(std::ostream& output) const {
+        std::lock_guard<std::mutex> lock(seriesMutex);
+        std::ostringstream text;
+        text << std::setprecision(12);
+        std::vector<bool> written(series.size(), false);
+        for (std::size_t i = 0; i < series.size(); i++) {
+            if (written[i]) {
+                continue;
+            }
+            text << "# HELP " << series[i]->name << ' ' << series[i]->help << '\n';
+            text << "# TYPE " << series[i]->name << ' ' << series[i]->type << '\n';
+            for (std::size_t j = i; j < series.size(); j++) {
+                const Series& metric = *series[j];
+                if (written[j] || metric.name != series[i]->name) {
+                    continue;
+                }
+                written[j] = true;
+                if (metric.histogramFunction) {
+                    renderHistogram(text, metric);
+                    continue;
+                }
+                text << metric.name << braces(metric.labels) << ' ';
+                if (metric.counter) {
+                    text << metric.counter->value();
+                } else if (metric.gauge) {
+                    text << metric.gauge->value();
+                } else {
+                    writeValue(text, metric.gaugeFunction());
+                }
+                text << '\n';
+            }
+        }
+        output << text.str();
+    }
+
+    std::string render() const {
+        std::ostringstream output;
+        render(output);
+        return output.str();
+    }
+
+    // Written to a temporary file and renamed, so a collector reading the file
+    // (e.g. node_exporter's textfile collector) never sees half of it
+    void writeToFile(const std::string& path) const {
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream output(temporary);
+            if (!output) {
+                throw std::runtime_error("Cannot write metrics: " + temporary);
+            }
+            render(output);
+        }
+        if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Cannot replace metrics file: " + path);
+        }
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <memory>
 #include <iostream>
 #include <algorithm>
+#include <mutex>
 
 // Observer pattern for notifications
 class Observer {
@@ -17,15 +18,18 @@ public:
 class Subject {
 private:
     std::vector<std::shared_ptr<Observer>> observers;
+    std::recursive_mutex observersMutex; // notifications may come from worker threads
     
 public:
     virtual ~Subject() = default;
     
     void addObserver(std::shared_ptr<Observer> observer) {
+        std::lock_guard<std::recursive_mutex> lock(observersMutex);
         observers.push_back(observer);
     }
     
     void removeObserver(std::shared_ptr<Observer> observer) {
+        std::lock_guard<std::recursive_mutex> lock(observersMutex);
         observers.erase(
             std::remove(observers.begin(), observers.end(), observer),
             observers.end()
@@ -33,6 +37,7 @@ public:
     }
     
     void notifyObservers(const std::string& event, const std::string& message) {
+        std::lock_guard<std::recursive_mutex> lock(observersMutex);
         for (const auto& observer : observers) {
             observer->update(event, message);
         }
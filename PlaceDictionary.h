@@ -0,0 +1,198 @@
+#ifndef PLACE_DICTIONARY_H
+#define PLACE_DICTIONARY_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <mutex>
+#include <stdexcept>
+#include <cstdint>
+
+using AddressId = std::uint32_t;
+using PlaceId = std::uint32_t;
+
+// A well-known place (station, landmark, popular pickup point). Coordinates are
+// int32 micro-degrees, the same quantization as GeoPoint.
+struct Place {
+    PlaceId id;
+    AddressId name;
+    std::int32_t latitudeE6;
+    std::int32_t longitudeE6;
+};
+
+// Process-wide place dictionary. Well-known places get a PlaceId in
+// registration order that never changes, and can be looked up exactly by name
+// or by coordinates. Their names are interned and referenced by a 4-byte
+// AddressId (ID 0 is the empty address), so the same "Churchgate" is stored a
+// single time however many rides use it. Only registerPlace adds names, so
+// free-form addresses never grow the dictionary. Nothing is ever removed and
+// address text never changes, so references returned by getAddress() stay
+// valid; a place can be moved, so getPlace() returns a copy.
+//
+// findAddress() and getAddress() run on every ride, so they read an immutable
+// snapshot of the names instead of taking the lock: each thread caches the
+// snapshot it last used and only re-reads it after a registration.
+class PlaceDictionary {
+public:
+    static constexpr AddressId NO_ADDRESS = 0;
+    static constexpr PlaceId NO_PLACE = 0xFFFFFFFFu;
+
+private:
+    std::deque<std::string> addresses{std::string()}; // deque: push_back never moves existing entries
+    std::unordered_map<std::string_view, AddressId> addressIds; // keys view into addresses
+    std::deque<Place> places;
+    std::unordered_map<AddressId, PlaceId> placesByName;
+    std::unordered_map<std::uint64_t, PlaceId> placesByPoint;
+    mutable std::shared_mutex dictionaryMutex;
+
+    // Immutable copy of the interned names; views and pointers refer into `addresses`
+    struct AddressIndex {
+        std::unordered_map<std::string_view, AddressId> ids;
+        std::vector<const std::string*> texts; // by AddressId
+    };
+
+    struct CachedIndex {
+        std::uint64_t generation = 0;
+        std::shared_ptr<const AddressIndex> index;
+    };
+
+    std::shared_ptr<const AddressIndex> addressIndex; // guarded by dictionaryMutex
+    std::atomic<std::uint64_t> indexGeneration{0};
+
+    PlaceDictionary() {
+        publishIndex();
+    }
+
+    // Caller holds the exclusive lock (or is the constructor)
+    void publishIndex() {
+        auto index = std::make_shared<AddressIndex>();
+        index->ids.reserve(addressIds.size());
+        index->ids.insert(addressIds.begin(), addressIds.end());
+        for (const std::string& text : addresses) {
+            index->texts.push_back(&text);
+        }
+        addressIndex = std::move(index);
+        indexGeneration.fetch_add(1, std::memory_order_release);
+    }
+
+    const AddressIndex& currentIndex() const {
+        static thread_local CachedIndex cache;
+        std::uint64_t generation = indexGeneration.load(std::memory_order_acquire);
+        if (cache.generation != generation) {
+            std::shared_lock<std::shared_mutex> lock(dictionaryMutex);
+            cache.index = addressIndex;
+            cache.generation = indexGeneration.load(std::memory_order_relaxed);
+        }
+        return *cache.index;
+    }
+
+    static std::uint64_t pointKey(std::int32_t latitudeE6, std::int32_t longitudeE6) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(latitudeE6)) << 32) |
+               static_cast<std::uint32_t>(longitudeE6);
+    }
+
+    // Caller holds the exclusive lock
+    AddressId internLocked(const std::string& address) {
+        auto it = addressIds.find(address);
+        if (it != addressIds.end()) {
+            return it->second;
+        }
+        auto id = static_cast<AddressId>(addresses.size());
+        addresses.push_back(address);
+        addressIds.emplace(addresses.back(), id);
+        return id;
+    }
+
+public:
+    static PlaceDictionary& getInstance() {
+        static PlaceDictionary dictionary;
+        return dictionary;
+    }
+
+    // ID of a registered place name, NO_ADDRESS for any other text; never blocks on writers
+    AddressId findAddress(const std::string& address) const {
+        if (address.empty()) {
+            return NO_ADDRESS;
+        }
+        const AddressIndex& index = currentIndex();
+        auto it = index.ids.find(address);
+        return it != index.ids.end() ? it->second : NO_ADDRESS;
+    }
+
+    const std::string& getAddress(AddressId id) const {
+        const AddressIndex& index = currentIndex();
+        return *(id < index.texts.size() ? index.texts[id] : index.texts[NO_ADDRESS]);
+    }
+
+    // Registers a well-known place; registering a known name again moves it and keeps its ID
+    PlaceId registerPlace(const std::string& name, std::int32_t latitudeE6, std::int32_t longitudeE6) {
+        if (name.empty()) {
+            throw std::invalid_argument("Place name cannot be empty");
+        }
+        std::unique_lock<std::shared_mutex> lock(dictionaryMutex);
+        std::size_t knownNames = addresses.size();
+        AddressId nameId = internLocked(name);
+        if (addresses.size() != knownNames) {
+            publishIndex();
+        }
+        auto existing = placesByName.find(nameId);
+        if (existing != placesByName.end()) {
+            Place& place = places[existing->second];
+            auto previous = placesByPoint.find(pointKey(place.latitudeE6, place.longitudeE6));
+            if (previous != placesByPoint.end() && previous->second == place.id) {
+                placesByPoint.erase(previous);
+            }
+            place.latitudeE6 = latitudeE6;
+            place.longitudeE6 = longitudeE6;
+            placesByPoint[pointKey(latitudeE6, longitudeE6)] = place.id;
+            return place.id;
+        }
+
+        auto id = static_cast<PlaceId>(places.size());
+        places.push_back({id, nameId, latitudeE6, longitudeE6});
+        placesByName[nameId] = id;
+        placesByPoint.emplace(pointKey(latitudeE6, longitudeE6), id); // first place at a point wins
+        return id;
+    }
+
+    PlaceId findPlace(const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(dictionaryMutex);
+        auto nameId = addressIds.find(name);
+        if (nameId == addressIds.end()) {
+            return NO_PLACE;
+        }
+        auto it = placesByName.find(nameId->second);
+        return it != placesByName.end() ? it->second : NO_PLACE;
+    }
+
+    PlaceId findPlaceAt(std::int32_t latitudeE6, std::int32_t longitudeE6) const {
+        std::shared_lock<std::shared_mutex> lock(dictionaryMutex);
+        auto it = placesByPoint.find(pointKey(latitudeE6, longitudeE6));
+        return it != placesByPoint.end() ? it->second : NO_PLACE;
+    }
+
+    Place getPlace(PlaceId id) const {
+        std::shared_lock<std::shared_mutex> lock(dictionaryMutex);
+        if (id >= places.size()) {
+            throw std::out_of_range("Unknown place ID: " + std::to_string(id));
+        }
+        return places[id];
+    }
+
+    std::size_t getAddressCount() const {
+        std::shared_lock<std::shared_mutex> lock(dictionaryMutex);
+        return addresses.size();
+    }
+
+    std::size_t getPlaceCount() const {
+        std::shared_lock<std::shared_mutex> lock(dictionaryMutex);
+        return places.size();
+    }
+};
+
+#endif
@@ -5,17 +5,23 @@
 #include "RideTypes.h"
 #include <memory>
 #include <chrono>
+#include <cstdint>
 
 class Ride {
 private:
     std::string rideId;
+    std::uint32_t denseId; // compact numeric ID assigned by RideManager
     std::shared_ptr<Rider> rider;
     std::shared_ptr<Driver> driver;
-    Location pickupLocation;
-    Location dropoffLocation;
+    CompactLocation pickupLocation;
+    CompactLocation dropoffLocation;
     RideType rideType;
     VehicleType requestedVehicleType;
     RideStatus status;
+    int passengerCount; // party size travelling on this booking
+    std::uint32_t pickupZoneId; // geofence zone of the pickup (0xFFFFFFFF = none)
+    bool airportPickup;         // pickupZoneId is an airport pickup zone
+    double pricingMultiplier;   // special pricing zones at the pickup
     double fare;
     double distance;
     std::chrono::system_clock::time_point requestTime;
@@ -25,20 +31,29 @@ private:
 public:
     Ride(const std::string& id, std::shared_ptr<Rider> rider,
          const Location& pickup, const Location& dropoff,
-         RideType type, VehicleType vehicleType)
-        : rideId(id), rider(rider), pickupLocation(pickup), dropoffLocation(dropoff),
+         RideType type, VehicleType vehicleType, std::uint32_t denseId = 0, int passengerCount = 1)
+        : rideId(id), denseId(denseId), rider(rider), pickupLocation(pickup), dropoffLocation(dropoff),
           rideType(type), requestedVehicleType(vehicleType), status(RideStatus::REQUESTED),
+          passengerCount(passengerCount), pickupZoneId(0xFFFFFFFFu), airportPickup(false),
+          pricingMultiplier(1.0),
           fare(0.0), distance(0.0), requestTime(std::chrono::system_clock::now()) {}
     
     // Getters
     const std::string& getRideId() const { return rideId; }
+    std::uint32_t getDenseId() const { return denseId; }
     std::shared_ptr<Rider> getRider() const { return rider; }
     std::shared_ptr<Driver> getDriver() const { return driver; }
-    const Location& getPickupLocation() const { return pickupLocation; }
-    const Location& getDropoffLocation() const { return dropoffLocation; }
+    Location getPickupLocation() const { return pickupLocation.toLocation(); }
+    Location getDropoffLocation() const { return dropoffLocation.toLocation(); }
+    const GeoPoint& getPickupPoint() const { return pickupLocation.point; }
+    const GeoPoint& getDropoffPoint() const { return dropoffLocation.point; }
     RideType getRideType() const { return rideType; }
     VehicleType getRequestedVehicleType() const { return requestedVehicleType; }
     RideStatus getStatus() const { return status; }
+    int getPassengerCount() const { return passengerCount; }
+    std::uint32_t getPickupZoneId() const { return pickupZoneId; }
+    bool isAirportPickup() const { return airportPickup; }
+    double getPricingMultiplier() const { return pricingMultiplier; }
     double getFare() const { return fare; }
     double getDistance() const { return distance; }
     
@@ -49,6 +64,11 @@ public:
     }
     void setStatus(RideStatus newStatus) { status = newStatus; }
     void setFare(double calculatedFare) { fare = calculatedFare; }
+    void setPickupZone(std::uint32_t zoneId, double multiplier, bool airport = false) {
+        pickupZoneId = zoneId;
+        airportPickup = airport;
+        pricingMultiplier = multiplier;
+    }
     void setDistance(double rideDistance) { distance = rideDistance; }
     void setStartTime() { startTime = std::chrono::system_clock::now(); }
     void setEndTime() { endTime = std::chrono::system_clock::now(); }
@@ -7,39 +7,286 @@
 #include "MatchingStrategy.h"
 #include "PricingStrategy.h"
 #include "Observer.h"
+#include "GeoUtils.h"
+#include "CarpoolRoutePlanner.h"
+#include "CarpoolMembership.h"
+#include "CarpoolBatcher.h"
+#include "DriverLocationStore.h"
+#include "IdleDriverIndex.h"
+#include "GeofenceEngine.h"
+#include "TrajectoryStore.h"
+#include "LatencyHistogram.h"
+#include "Tracing.h"
+#include "MetricsRegistry.h"
+#include "MatchTelemetry.h"
+#include "FlightRecorder.h"
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <random>
 #include <cmath>
 #include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <functional>
+#include <limits>
 
-// Singleton pattern for ride management
+// Engine stages with their own latency histogram
+enum class EngineOperation { REQUEST_RIDE, MATCHING, PRICING, NOTIFICATION, UPDATE_RIDE_STATUS };
+constexpr std::size_t ENGINE_OPERATION_COUNT = 5;
+
+// Singleton pattern for ride management (standalone engines can also be constructed)
 class RideManager : public Subject {
 private:
     static std::unique_ptr<RideManager> instance;
+    static constexpr double DEFAULT_DISPATCH_RADIUS_KM = 10.0;
+    static constexpr std::size_t MIN_DISPATCH_CANDIDATES = 8; // idle drivers gathered before the grid probe stops
     std::unordered_map<std::string, std::shared_ptr<Driver>> drivers;
     std::unordered_map<std::string, std::shared_ptr<Rider>> riders;
     std::unordered_map<std::string, std::shared_ptr<Ride>> rides;
-    std::unordered_map<std::string, std::vector<std::string>> carpoolRides; // driver -> ride IDs
+    std::unordered_map<std::string, std::uint32_t> driverSlots; // driver ID -> dense driver ID
+    std::vector<std::shared_ptr<Driver>> driversBySlot;
+    
+    // Vehicle facts by dense driver ID, so candidate scans skip other vehicle types
+    // without touching the Driver objects (vehicles never change after registration)
+    struct DriverTraits {
+        std::uint16_t vehicleType; // index into vehicleTypeNames
+        std::uint16_t capacity;
+    };
+    std::vector<DriverTraits> driverTraits;
+    std::vector<std::string> vehicleTypeNames;
+    CarpoolMembership carpoolMembership; // dense driver -> seat array of dense ride IDs
+    DriverLocationStore locationStore;   // live driver coordinates by dense driver ID
+    TrajectoryStore trajectories;        // compressed recent GPS trail by dense driver ID
+    IdleDriverIndex idleDrivers;         // AVAILABLE drivers by grid cell, probed around each pickup
+    std::vector<std::uint32_t> movedSlots; // drivers with a new fix, re-bucketed at the next dispatch
+    std::vector<char> movedFlags;          // by dense driver ID: already queued in movedSlots
+    std::vector<std::uint32_t> movedDrained;
+    std::mutex movedMutex;   // movedSlots and movedFlags; ingestion takes only this, never engineMutex
+    double dispatchRadiusKm; // normal rides never go to a driver further away than this
     std::unique_ptr<MatchingStrategy> matchingStrategy;
     std::unique_ptr<PricingCalculator> pricingCalculator;
+    CarpoolRoutePlanner carpoolPlanner; // pending stop sequence per carpool driver
+    GeofenceEngine geofences;           // airport, no-pickup and special pricing zones
     int rideCounter;
+    std::mt19937 acceptanceRng;
+    std::function<std::int64_t()> clock; // milliseconds; replaceable so simulations can run on virtual time
+    std::int64_t predictionHorizonMs;    // how far past a GPS fix driver positions are dead-reckoned
+    std::recursive_mutex engineMutex; // public operations may come from several threads
+    std::shared_mutex locationMutex;  // driverSlots and clock for the location path; writers also hold engineMutex
+    ShardedLatencyRecorder<ENGINE_OPERATION_COUNT> latencies; // per-stage timings, recorded outside any lock
+    MetricsRegistry metrics;                                  // Prometheus exposition of the engine
+    MetricCounter* ridesRequested[2];                         // by RideType
+    MetricCounter* ridesAssigned;
+    MetricCounter* ridesUnassigned;
+    MetricCounter* ridesCompleted;
+    MetricCounter* ridesCancelled;
+    MetricCounter* matchAttempts;
+    MetricCounter* driverRejections;
+    MetricCounter* notificationsSent;
+    MetricGauge* notificationsInFlight; // deliveries running or waiting for the observer lock
+    std::atomic<std::int64_t> driverStateCounts[3]; // by DriverStatus, as of the last successful scrape
+    MatchTelemetry matchTelemetry;                  // rolling match cost/quality by vehicle type and zone
+    std::function<void(const MatchRecord&)> matchListener;
+    FlightRecorder& flightRecorder;                 // process-wide black box of API calls and state changes
+    std::atomic<std::int64_t> slowRequestNs{0};     // requestRide slower than this is an anomaly; 0 disables
+    CarpoolBatcher carpoolBatcher;    // declared last: its worker must stop before the rest is destroyed
     
-    RideManager() : rideCounter(0) {
-        matchingStrategy = std::make_unique<NearestDriverStrategy>();
-        pricingCalculator = std::make_unique<BasePricingCalculator>();
+    using StageTimer = ScopedLatency<ShardedLatencyRecorder<ENGINE_OPERATION_COUNT>>;
+    
+    StageTimer timeStage(EngineOperation operation) {
+        return StageTimer(latencies, static_cast<std::size_t>(operation));
+    }
+    
+    // Closes a requestRide in the flight recorder, after the engine lock is released
+    struct RequestWatch {
+        RideManager& engine;
+        std::uint32_t ride;
+        std::chrono::steady_clock::time_point start;
+        
+        explicit RequestWatch(RideManager& engine)
+            : engine(engine), ride(0),
+              start(engine.flightRecorder.isEnabled() ? std::chrono::steady_clock::now()
+                                                      : std::chrono::steady_clock::time_point()) {}
+        ~RequestWatch() { engine.closeFlightRequest(ride, start); }
+    };
+    
+    void closeFlightRequest(std::uint32_t ride, std::chrono::steady_clock::time_point start) {
+        if (!flightRecorder.isEnabled() || start == std::chrono::steady_clock::time_point()) {
+            return;
+        }
+        std::int64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        flightRecorder.record(FlightEvent::REQUEST_DONE, 0, ride, 0, elapsedNs);
+        std::int64_t threshold = slowRequestNs.load(std::memory_order_relaxed);
+        if (threshold > 0 && elapsedNs > threshold) {
+            flightRecorder.triggerAnomaly(FlightAnomaly::SLOW_REQUEST, ride, elapsedNs);
+        }
+    }
+    
+    // Every driver status change goes through here so the flight recorder and the
+    // idle-driver index see it
+    void setDriverStatus(const std::shared_ptr<Driver>& driver, DriverStatus status) {
+        if (flightRecorder.isEnabled()) {
+            flightRecorder.record(FlightEvent::DRIVER_STATUS, static_cast<std::uint16_t>(status), driverSlot(driver),
+                                  static_cast<std::uint32_t>(driver->getStatus()));
+        }
+        driver->setStatus(status);
+        std::uint32_t slot = driverSlot(driver);
+        if (status == DriverStatus::AVAILABLE) {
+            idleDrivers.insert(slot, driverTraits[slot].vehicleType, locationStore.read(slot));
+        } else {
+            idleDrivers.remove(slot);
+        }
+    }
+    
+    // Queues drivers whose fix changed so the idle index can re-bucket them. Runs on
+    // the ingestion path, so it takes only movedMutex.
+    void noteMoved(const DriverLocationUpdate* updates, std::size_t count) {
+        std::lock_guard<std::mutex> lock(movedMutex);
+        for (std::size_t i = 0; i < count; i++) {
+            std::uint32_t slot = updates[i].driverSlot;
+            if (slot < movedFlags.size() && !movedFlags[slot]) {
+                movedFlags[slot] = 1;
+                movedSlots.push_back(slot);
+            }
+        }
+    }
+    
+    // Moves idle drivers to the cells of their latest fixes; caller holds the engine lock
+    void syncIdleDriverPositions() {
+        {
+            std::lock_guard<std::mutex> lock(movedMutex);
+            movedDrained.swap(movedSlots);
+            for (std::uint32_t slot : movedDrained) {
+                movedFlags[slot] = 0;
+            }
+        }
+        for (std::uint32_t slot : movedDrained) {
+            idleDrivers.update(slot, locationStore.read(slot));
+        }
+        movedDrained.clear();
+    }
+    
+    // Visits idle drivers of one vehicle type ring by ring outward from `centre`.
+    // visit(slot, driver) returns true for a driver it took. Probing stops one
+    // ring after `wanted` drivers were taken (a nearer driver can only sit in
+    // the next ring) or once the rings cover radiusKm plus how far dead
+    // reckoning may move a driver past its fix.
+    template <typename Visit>
+    void forEachIdleDriverNear(std::uint16_t vehicleType, const GeoPoint& centre, double radiusKm, std::size_t wanted,
+                               MatchRecord& match, Visit&& visit) {
+        double reckoningKm = DriverLocationStore::MAX_SPEED_KMH * predictionHorizonMs / 3600000.0;
+        int lastRing = idleDrivers.ringsFor(centre, radiusKm + reckoningKm);
+        std::size_t taken = 0;
+        for (int ring = 0; ring <= lastRing; ring++) {
+            match.bucketsProbed += static_cast<std::uint32_t>(
+                idleDrivers.forEachInRing(vehicleType, centre, ring, [&](std::uint32_t slot) {
+                    match.slotsScanned++;
+                    if (visit(slot, driversBySlot[slot])) {
+                        taken++;
+                    }
+                }));
+            if (taken >= wanted) {
+                lastRing = std::min(lastRing, ring + 1);
+            }
+        }
+    }
+    
+    void registerMetrics() {
+        ridesRequested[static_cast<int>(RideType::NORMAL)] =
+            &metrics.counter("rideeasy_rides_requested_total", "Ride requests accepted by the engine", "type=\"normal\"");
+        ridesRequested[static_cast<int>(RideType::CARPOOL)] =
+            &metrics.counter("rideeasy_rides_requested_total", "Ride requests accepted by the engine", "type=\"carpool\"");
+        ridesAssigned = &metrics.counter("rideeasy_rides_assigned_total", "Rides that got a driver");
+        ridesUnassigned = &metrics.counter("rideeasy_rides_unassigned_total",
+                                           "Rides left without a driver (none available or all rejected)");
+        ridesCompleted = &metrics.counter("rideeasy_rides_completed_total", "Rides completed and paid");
+        ridesCancelled = &metrics.counter("rideeasy_rides_cancelled_total", "Rides cancelled");
+        matchAttempts = &metrics.counter("rideeasy_match_attempts_total", "Rides offered to a matched driver");
+        driverRejections = &metrics.counter("rideeasy_driver_rejections_total", "Ride offers rejected by the driver");
+        notificationsSent = &metrics.counter("rideeasy_notifications_total", "Observer notifications sent");
+        notificationsInFlight = &metrics.gauge("rideeasy_notification_queue_depth",
+                                               "Notifications being delivered or waiting for the observer lock");
+        metrics.gaugeFunction("rideeasy_carpool_batch_queue_depth", "Carpool requests waiting for the batching window",
+                              "", [this]() { return static_cast<double>(carpoolBatcher.getPendingCount()); });
+        
+        // Rendered in registration order, so the first state refreshes all three
+        static const char* const states[] = {"available", "on_trip", "offline"};
+        for (int state = 0; state < 3; state++) {
+            driverStateCounts[state].store(0, std::memory_order_relaxed);
+            metrics.gaugeFunction("rideeasy_drivers", "Registered drivers by state",
+                                  std::string("state=\"") + states[state] + "\"", [this, state]() {
+                                      if (state == 0) {
+                                          refreshDriverStateCounts();
+                                      }
+                                      return static_cast<double>(driverStateCounts[state].load(std::memory_order_relaxed));
+                                  });
+        }
+        
+        for (std::size_t stage = 0; stage < ENGINE_OPERATION_COUNT; stage++) {
+            metrics.histogramFunction("rideeasy_engine_stage_duration_seconds", "Time spent in each engine stage",
+                                      std::string("stage=\"") + getOperationName(static_cast<EngineOperation>(stage)) + "\"",
+                                      [this, stage]() { return latencies.snapshot(stage); });
+        }
+    }
+    
+    // Counting needs the engine lock; a scrape that would have to wait for it
+    // keeps the previous counts instead
+    void refreshDriverStateCounts() {
+        std::unique_lock<std::recursive_mutex> lock(engineMutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        std::int64_t counts[3] = {0, 0, 0};
+        for (const auto& driver : driversBySlot) {
+            counts[static_cast<int>(driver->getStatus())]++;
+        }
+        for (int state = 0; state < 3; state++) {
+            driverStateCounts[state].store(counts[state], std::memory_order_relaxed);
+        }
     }
     
     std::string generateRideId() {
         return "RIDE_" + std::to_string(++rideCounter);
     }
     
-    double calculateDistance(const Location& pickup, const Location& dropoff) {
+    std::uint32_t driverSlot(const std::shared_ptr<Driver>& driver) const {
+        return driverSlots.at(driver->getUserId());
+    }
+    
+    std::uint16_t vehicleTypeId(const std::string& name) {
+        auto it = std::find(vehicleTypeNames.begin(), vehicleTypeNames.end(), name);
+        if (it != vehicleTypeNames.end()) {
+            return static_cast<std::uint16_t>(it - vehicleTypeNames.begin());
+        }
+        vehicleTypeNames.push_back(name);
+        return static_cast<std::uint16_t>(vehicleTypeNames.size() - 1);
+    }
+    
+    // Where matching assumes one driver is now (last fix, dead-reckoned)
+    GeoPoint driverPosition(const std::shared_ptr<Driver>& driver) const {
+        return locationStore.predict(driverSlot(driver), clock(), predictionHorizonMs);
+    }
+    
+    // Zone a driver at this position belongs to; airport zones win so queues are exact
+    ZoneId driverZone(const GeoPoint& position) const {
+        GeofenceStatus status = geofences.query(position);
+        return status.airportZoneId != GeofenceEngine::NO_ZONE ? status.airportZoneId : status.zoneId;
+    }
+    
+    // Positions of all candidates (given by dense driver ID) from one consistent snapshot
+    void readPositions(const std::vector<std::uint32_t>& slots, std::vector<GeoPoint>& positions) const {
+        positions.resize(slots.size());
+        locationStore.predict(slots.data(), slots.size(), positions.data(), clock(), predictionHorizonMs);
+    }
+    
+    double calculateDistance(const GeoPoint& pickup, const GeoPoint& dropoff) {
         // Simple distance calculation with realistic scaling
-        double latDiff = pickup.latitude - dropoff.latitude;
-        double lngDiff = pickup.longitude - dropoff.longitude;
-        return std::sqrt(latDiff * latDiff + lngDiff * lngDiff) * 111.0; // Convert to km (1 degree ≈ 111 km)
+        return GeoUtils::distanceKm(pickup, dropoff);
     }
     
     bool canDriverAcceptCarpool(std::shared_ptr<Driver> driver) {
@@ -47,17 +294,431 @@ private:
             return false;
         }
         
-        auto it = carpoolRides.find(driver->getUserId());
-        if (it == carpoolRides.end()) {
-            return true; // No carpool rides
+        // Room for another booking; seats per leg are checked by the route planner
+        std::size_t currentBookings = carpoolMembership.getGroupSize(driverSlot(driver));
+        std::size_t seats = std::min<std::size_t>(driver->getVehicle().capacity, CarpoolMembership::MAX_SEATS);
+        return currentBookings < seats;
+    }
+    
+    // Frees a carpool ride's seat and route stops; runs on every terminal ride state
+    void releaseCarpoolSeat(const std::shared_ptr<Ride>& ride) {
+        std::uint32_t slot = carpoolMembership.leave(ride->getDenseId());
+        if (slot == CarpoolMembership::NO_DRIVER) {
+            // No seat on record: still clear stops the ride's driver may hold for it
+            auto driver = ride->getDriver();
+            if (!driver || !routeHasRide(driver->getUserId(), ride->getRideId())) {
+                return; // never seated, or already released
+            }
+            slot = driverSlot(driver);
+        }
+        
+        auto driver = driversBySlot[slot];
+        carpoolPlanner.removeRide(driver->getUserId(), driverPosition(driver), ride->getRideId());
+        
+        // If no more carpool rides, set driver to available
+        if (carpoolMembership.getGroupSize(slot) == 0 && driver->getStatus() == DriverStatus::ON_TRIP) {
+            setDriverStatus(driver, DriverStatus::AVAILABLE);
+        }
+    }
+    
+    // Pools heading toward the dropoff (index probe) plus idle drivers who could start a new pool
+    void collectCarpoolCandidates(const GeoPoint& pickup, const GeoPoint& dropoff, VehicleType vehicleType, int passengers,
+                                  std::vector<std::shared_ptr<Driver>>& candidates,
+                                  std::vector<std::uint32_t>& slots, MatchRecord& match) {
+        std::string requestedTypeName = VehicleTypeFactory::getVehicleTypeName(vehicleType);
+        double pickupRangeKm = carpoolPlanner.getConfig().maxPickupDistanceKm;
+        
+        std::size_t bucketsProbed = 0;
+        std::vector<std::string> pools = carpoolPlanner.findCompatibleGroups(pickup, dropoff, &bucketsProbed);
+        match.bucketsProbed = static_cast<std::uint32_t>(bucketsProbed);
+        match.slotsScanned = static_cast<std::uint32_t>(pools.size());
+        for (const auto& driverId : pools) {
+            auto it = driverSlots.find(driverId);
+            if (it == driverSlots.end()) {
+                continue;
+            }
+            const auto& driver = driversBySlot[it->second];
+            if (driver->getVehicle().vehicleType == requestedTypeName &&
+                GeoUtils::distanceKm(driverPosition(driver), pickup) <= pickupRangeKm &&
+                canDriverAcceptCarpool(driver)) {
+                candidates.push_back(driver);
+                slots.push_back(it->second);
+            }
+        }
+        
+        auto addIdle = [&](std::uint32_t slot, const std::shared_ptr<Driver>& driver, double) {
+            candidates.push_back(driver);
+            slots.push_back(slot);
+        };
+        forEachIdleCarpoolDriver(vehicleType, passengers, pickup, pickupRangeKm, match, addIdle);
+    }
+    
+    // Idle drivers of one vehicle type with room for a new pool of `seats` passengers
+    // whose predicted position is within radiusKm of `pickup`, from the grid cells
+    // around it; shared by immediate and batched carpool matching.
+    // visit(slot, driver, distanceKm) sees each of them once.
+    template <typename Visit>
+    void forEachIdleCarpoolDriver(VehicleType vehicleType, int seats, const GeoPoint& pickup, double radiusKm,
+                                  MatchRecord& match, Visit&& visit) {
+        std::uint16_t requestedType = vehicleTypeId(VehicleTypeFactory::getVehicleTypeName(vehicleType));
+        std::int64_t nowMs = clock();
+        auto visitInRange = [&](std::uint32_t slot, const std::shared_ptr<Driver>& driver) {
+            if (driverTraits[slot].capacity < seats || driver->getStatus() != DriverStatus::AVAILABLE ||
+                carpoolPlanner.hasActiveRoute(driver->getUserId())) {
+                return false;
+            }
+            double distance = GeoUtils::distanceKm(locationStore.predict(slot, nowMs, predictionHorizonMs), pickup);
+            if (distance > radiusKm) {
+                return false;
+            }
+            visit(slot, driver, distance);
+            return true;
+        };
+        forEachIdleDriverNear(requestedType, pickup, radiusKm, std::numeric_limits<std::size_t>::max(), match,
+                              visitInRange);
+    }
+    
+    // Simulated driver acceptance (85% acceptance rate for first attempt, decreasing)
+    bool driverAccepts(int attempts) {
+        std::uniform_real_distribution<> dis(0.0, 1.0);
+        double acceptanceRate = 0.85 - (attempts * 0.1); // 85%, 75%, 65%
+        return dis(acceptanceRng) < acceptanceRate;
+    }
+    
+    bool routeHasRide(const std::string& driverId, const std::string& rideId) const {
+        const auto& stops = carpoolPlanner.getRoute(driverId);
+        return std::any_of(stops.begin(), stops.end(), [&](const RouteStop& stop) { return stop.rideId == rideId; });
+    }
+    
+    // Commits an accepted carpool insertion: seat, route stops and driver state.
+    // The seat is taken first; when the driver has none left nothing is
+    // committed and false is returned.
+    bool seatCarpoolRider(const std::shared_ptr<Ride>& ride, const CarpoolInsertion& insertion) {
+        const auto& driver = insertion.driver;
+        if (!carpoolMembership.join(driverSlot(driver), ride->getDenseId())) {
+            return false;
+        }
+        ride->assignDriver(driver);
+        carpoolPlanner.commitInsertion(insertion, ride->getRideId(), ride->getPickupPoint(),
+                                       ride->getDropoffPoint(), ride->getPassengerCount());
+        if (driver->getStatus() == DriverStatus::AVAILABLE) {
+            setDriverStatus(driver, DriverStatus::ON_TRIP);
+        }
+        ridesAssigned->add();
+        notifyObservers("DRIVER_ASSIGNED", 
+                      "Driver " + driver->getName() + " assigned to ride " + ride->getRideId());
+        return true;
+    }
+    
+    // Closes a dispatch's telemetry record
+    void recordMatch(MatchRecord& match, std::chrono::steady_clock::time_point start) {
+        match.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        matchTelemetry.record(match, clock());
+        if (matchListener) {
+            matchListener(match);
+        }
+    }
+    
+    // Finds and assigns a driver for a freshly requested ride
+    void dispatchRide(const std::shared_ptr<Ride>& ride) {
+        auto dispatchStart = std::chrono::steady_clock::now();
+        const std::string& rideId = ride->getRideId();
+        const GeoPoint& pickup = ride->getPickupPoint();
+        const GeoPoint& dropoff = ride->getDropoffPoint();
+        RideType rideType = ride->getRideType();
+        VehicleType vehicleType = ride->getRequestedVehicleType();
+        RIDEEASY_TRACE_SCOPE("dispatchRide");
+        MatchRecord match;
+        match.vehicleType = vehicleType;
+        match.zone = ride->getPickupZoneId();
+        match.rideType = rideType;
+        
+        // Find available drivers based on ride type (by dense ID, which also gives
+        // each candidate's slot in the location store)
+        std::vector<std::shared_ptr<Driver>> availableDrivers;
+        std::vector<std::uint32_t> candidateSlots;
+        {
+            RIDEEASY_TRACE_SCOPE("collectCandidates");
+            syncIdleDriverPositions();
+            if (rideType == RideType::CARPOOL) {
+                collectCarpoolCandidates(pickup, dropoff, vehicleType, ride->getPassengerCount(), availableDrivers,
+                                         candidateSlots, match);
+            } else {
+                // Idle drivers from the grid cells around the pickup, nearest rings first
+                bool sameTypeOnly = matchingStrategy->requiresVehicleTypeMatch();
+                std::uint16_t requestedType = vehicleTypeId(VehicleTypeFactory::getVehicleTypeName(vehicleType));
+                auto addIdle = [&](std::uint32_t slot, const std::shared_ptr<Driver>& driver) {
+                    if (driverTraits[slot].capacity < ride->getPassengerCount() ||
+                        driver->getStatus() != DriverStatus::AVAILABLE) {
+                        return false;
+                    }
+                    availableDrivers.push_back(driver);
+                    candidateSlots.push_back(slot);
+                    return true;
+                };
+                for (std::uint16_t type = 0; type < vehicleTypeNames.size(); type++) {
+                    if (!sameTypeOnly || type == requestedType) {
+                        forEachIdleDriverNear(type, pickup, dispatchRadiusKm, MIN_DISPATCH_CANDIDATES, match, addIdle);
+                    }
+                }
+            }
+            
+            // Airport pickups are served from drivers waiting in the same airport zone, if any
+            // (the zone was looked up once, when the ride was requested)
+            if (ride->isAirportPickup()) {
+                ZoneId airportZone = ride->getPickupZoneId();
+                std::vector<std::shared_ptr<Driver>> queued;
+                std::vector<std::uint32_t> queuedSlots;
+                for (std::size_t i = 0; i < availableDrivers.size(); i++) {
+                    if (locationStore.getZone(candidateSlots[i]) == airportZone) {
+                        queued.push_back(availableDrivers[i]);
+                        queuedSlots.push_back(candidateSlots[i]);
+                    }
+                }
+                if (!queued.empty()) {
+                    availableDrivers.swap(queued);
+                    candidateSlots.swap(queuedSlots);
+                }
+            }
+        }
+        
+        // Matching works on one snapshot of the candidates' live positions. Grid
+        // rings are square, so normal rides drop the corners past the radius.
+        std::vector<GeoPoint> positions;
+        {
+            RIDEEASY_TRACE_SCOPE("readPositions");
+            readPositions(candidateSlots, positions);
+            if (rideType == RideType::NORMAL) {
+                std::size_t kept = 0;
+                for (std::size_t i = 0; i < availableDrivers.size(); i++) {
+                    if (GeoUtils::distanceKm(positions[i], pickup) <= dispatchRadiusKm) {
+                        availableDrivers[kept] = availableDrivers[i];
+                        candidateSlots[kept] = candidateSlots[i];
+                        positions[kept] = positions[i];
+                        kept++;
+                    }
+                }
+                availableDrivers.resize(kept);
+                candidateSlots.resize(kept);
+                positions.resize(kept);
+            }
+        }
+        
+        match.candidates = static_cast<std::uint32_t>(availableDrivers.size());
+        if (availableDrivers.empty()) {
+            recordMatch(match, dispatchStart);
+            ridesUnassigned->add();
+            flightRecorder.record(FlightEvent::NO_DRIVER, 0, ride->getDenseId(), 0);
+            notifyObservers("NO_DRIVER_AVAILABLE", 
+                          "No drivers available for ride " + rideId + ". Please try again later.");
+            return;
+        }
+        
+        // Try to assign driver with improved fallback mechanism
+        bool driverAssigned = false;
+        std::shared_ptr<Driver> assignedDriver = nullptr;
+        
+        // Attempt assignment with up to 3 drivers
+        int attempts = 0;
+        {
+            RIDEEASY_TRACE_SCOPE("acceptanceLoop");
+            while (!driverAssigned && !availableDrivers.empty() && attempts < 3) {
+                // Carpools are matched by route insertion (detour-limited), normal rides by the strategy
+                CarpoolInsertion insertion;
+                {
+                    auto timer = timeStage(EngineOperation::MATCHING);
+                    RIDEEASY_TRACE_SCOPE("matching");
+                    if (rideType == RideType::CARPOOL) {
+                        insertion = carpoolPlanner.findBestInsertion(availableDrivers, positions, rideId, pickup,
+                                                                     dropoff, ride->getPassengerCount());
+                        assignedDriver = insertion.driver;
+                    } else {
+                        assignedDriver =
+                            matchingStrategy->findBestDriver(availableDrivers, positions, pickup, vehicleType);
+                    }
+                }
+                
+                if (!assignedDriver) {
+                    break; // No suitable driver found
+                }
+                
+                // Remove this driver (and its slot and position) from the candidates
+                auto dropCandidate = [&]() {
+                    auto dropped = std::find(availableDrivers.begin(), availableDrivers.end(), assignedDriver);
+                    auto offset = dropped - availableDrivers.begin();
+                    std::uint32_t slot = candidateSlots[offset];
+                    positions.erase(positions.begin() + offset);
+                    candidateSlots.erase(candidateSlots.begin() + offset);
+                    availableDrivers.erase(dropped);
+                    return slot;
+                };
+                
+                matchAttempts->add();
+                match.attempts++;
+                if (driverAccepts(attempts)) {
+                    if (rideType == RideType::CARPOOL && !seatCarpoolRider(ride, insertion)) {
+                        dropCandidate(); // no seat left in the driver's group; try the next one
+                        continue;
+                    }
+                    match.assigned = true;
+                    match.pickupKm = GeoUtils::distanceKm(driverPosition(assignedDriver), pickup);
+                    if (rideType == RideType::NORMAL) {
+                        ride->assignDriver(assignedDriver);
+                        setDriverStatus(assignedDriver, DriverStatus::ON_TRIP);
+                        ridesAssigned->add();
+                        notifyObservers("DRIVER_ASSIGNED", 
+                                      "Driver " + assignedDriver->getName() + " assigned to ride " + rideId);
+                    }
+                    if (flightRecorder.isEnabled()) {
+                        flightRecorder.record(FlightEvent::DRIVER_ASSIGNED, static_cast<std::uint16_t>(match.attempts),
+                                              ride->getDenseId(), driverSlot(assignedDriver));
+                    }
+                    driverAssigned = true;
+                } else {
+                    driverRejections->add();
+                    notifyObservers("DRIVER_REJECTED", 
+                                  "Driver " + assignedDriver->getName() + " rejected ride " + rideId);
+                    
+                    std::uint32_t rejectedSlot = dropCandidate();
+                    if (flightRecorder.isEnabled()) {
+                        flightRecorder.record(FlightEvent::DRIVER_REJECTED, 0, ride->getDenseId(), rejectedSlot);
+                    }
+                    attempts++;
+                }
+            }
+        }
+        
+        recordMatch(match, dispatchStart);
+        if (!driverAssigned) {
+            ridesUnassigned->add();
+            flightRecorder.record(FlightEvent::NO_DRIVER, static_cast<std::uint16_t>(match.attempts),
+                                  ride->getDenseId(), match.candidates);
+            notifyObservers("NO_DRIVER_ASSIGNED", 
+                          "Failed to assign driver for ride " + rideId + " after " + std::to_string(attempts) + " attempts");
+        }
+    }
+    
+    // Solves one batching window: each cluster of compatible requests is offered as a
+    // whole to an idle driver, cheapest (cluster, driver) pairs first. Riders that do
+    // not fit a group fall back to individual matching.
+    void assignCarpoolBatch(const std::vector<PendingCarpoolRequest>& batch,
+                            const std::vector<CarpoolCluster>& clusters) {
+        RIDEEASY_TRACE_SCOPE("assignCarpoolBatch");
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        syncIdleDriverPositions();
+        
+        struct GroupOffer {
+            double pickupDistanceKm;
+            std::size_t cluster;
+            std::shared_ptr<Driver> driver;
+        };
+        
+        const std::size_t offersPerCluster = 5;
+        double pickupRangeKm = carpoolPlanner.getConfig().maxPickupDistanceKm;
+        std::vector<GroupOffer> offers;
+        
+        for (std::size_t c = 0; c < clusters.size(); c++) {
+            const auto& seed = batch[clusters[c].members.front()];
+            std::vector<GroupOffer> clusterOffers;
+            
+            auto offer = [&](std::uint32_t, const std::shared_ptr<Driver>& driver, double distance) {
+                clusterOffers.push_back({distance, c, driver});
+            };
+            MatchRecord probes; // batched groups have no per-request match record
+            forEachIdleCarpoolDriver(clusters[c].vehicleType, clusters[c].seats, seed.pickup, pickupRangeKm, probes,
+                                     offer);
+            
+            auto byDistance = [](const GroupOffer& a, const GroupOffer& b) {
+                return a.pickupDistanceKm < b.pickupDistanceKm;
+            };
+            if (clusterOffers.size() > offersPerCluster) {
+                std::partial_sort(clusterOffers.begin(), clusterOffers.begin() + offersPerCluster,
+                                  clusterOffers.end(), byDistance);
+                clusterOffers.resize(offersPerCluster);
+            }
+            offers.insert(offers.end(), clusterOffers.begin(), clusterOffers.end());
+        }
+        
+        std::sort(offers.begin(), offers.end(), [](const GroupOffer& a, const GroupOffer& b) {
+            return a.pickupDistanceKm < b.pickupDistanceKm;
+        });
+        
+        std::vector<bool> clusterAssigned(clusters.size(), false);
+        std::vector<bool> requestSeated(batch.size(), false);
+        std::vector<std::shared_ptr<Driver>> usedDrivers;
+        
+        for (const auto& offer : offers) {
+            if (clusterAssigned[offer.cluster] ||
+                std::find(usedDrivers.begin(), usedDrivers.end(), offer.driver) != usedDrivers.end()) {
+                continue;
+            }
+            usedDrivers.push_back(offer.driver);
+            
+            if (!driverAccepts(0)) {
+                if (flightRecorder.isEnabled()) {
+                    flightRecorder.record(FlightEvent::DRIVER_REJECTED, 0, 0, driverSlot(offer.driver));
+                }
+                notifyObservers("DRIVER_REJECTED", 
+                              "Driver " + offer.driver->getName() + " rejected carpool group of " +
+                              std::to_string(clusters[offer.cluster].members.size()));
+                continue;
+            }
+            clusterAssigned[offer.cluster] = true;
+            
+            std::vector<std::shared_ptr<Driver>> groupDriver{offer.driver};
+            std::vector<GeoPoint> groupPosition{driverPosition(offer.driver)};
+            for (std::size_t member : clusters[offer.cluster].members) {
+                auto ride = getRide(batch[member].rideId);
+                if (!ride || ride->getStatus() != RideStatus::REQUESTED) {
+                    continue; // cancelled while waiting for the window
+                }
+                if (!canDriverAcceptCarpool(offer.driver)) {
+                    break; // bookings reached the vehicle's (or the seat array's) limit
+                }
+                CarpoolInsertion insertion = carpoolPlanner.findBestInsertion(
+                    groupDriver, groupPosition, ride->getRideId(), ride->getPickupPoint(), ride->getDropoffPoint(),
+                    ride->getPassengerCount());
+                if (insertion.driver && seatCarpoolRider(ride, insertion)) {
+                    if (flightRecorder.isEnabled()) {
+                        flightRecorder.record(FlightEvent::DRIVER_ASSIGNED, 0, ride->getDenseId(),
+                                              driverSlot(offer.driver));
+                    }
+                    requestSeated[member] = true;
+                }
+            }
         }
         
-        // Check if driver has capacity for more passengers
-        int currentPassengers = it->second.size();
-        return currentPassengers < driver->getVehicle().capacity;
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            if (requestSeated[i]) {
+                continue;
+            }
+            auto ride = getRide(batch[i].rideId);
+            if (ride && ride->getStatus() == RideStatus::REQUESTED) {
+                dispatchRide(ride);
+            }
+        }
     }
     
 public:
+    // Standalone engine, independent of the shared instance (e.g. one per
+    // simulation run); the application itself uses getInstance()
+    RideManager()
+        : dispatchRadiusKm(DEFAULT_DISPATCH_RADIUS_KM), rideCounter(0), acceptanceRng(std::random_device{}()),
+          predictionHorizonMs(10000),
+          flightRecorder(FlightRecorder::instance()) {
+        clock = []() {
+            return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        };
+        matchingStrategy = std::make_unique<NearestDriverStrategy>();
+        pricingCalculator = std::make_unique<BasePricingCalculator>();
+        registerMetrics();
+    }
+    
+    RideManager(const RideManager&) = delete;
+    RideManager& operator=(const RideManager&) = delete;
+    
     static RideManager& getInstance() {
         if (!instance) {
             instance = std::unique_ptr<RideManager>(new RideManager());
@@ -67,133 +728,306 @@ public:
     
     // User management
     void registerRider(std::shared_ptr<Rider> rider) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         if (!rider) {
             throw std::invalid_argument("Cannot register null rider");
         }
         riders[rider->getUserId()] = rider;
+        flightRecorder.record(FlightEvent::REGISTER_RIDER, 0, static_cast<std::uint32_t>(riders.size()));
         notifyObservers("USER_REGISTERED", "Rider " + rider->getName() + " registered successfully");
     }
     
     void registerDriver(std::shared_ptr<Driver> driver) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         if (!driver) {
             throw std::invalid_argument("Cannot register null driver");
         }
         drivers[driver->getUserId()] = driver;
+        
+        DriverTraits traits{vehicleTypeId(driver->getVehicle().vehicleType),
+                            static_cast<std::uint16_t>(std::max(0, driver->getVehicle().capacity))};
+        auto slot = driverSlots.find(driver->getUserId());
+        if (slot == driverSlots.end()) {
+            // The slot is published last, once its location and trail storage exist
+            auto newSlot = static_cast<std::uint32_t>(driversBySlot.size());
+            locationStore.addDriver(newSlot, driver->getPosition(), 0, driverZone(driver->getPosition()));
+            trajectories.addDriver(newSlot);
+            driversBySlot.push_back(driver);
+            driverTraits.push_back(traits);
+            {
+                std::lock_guard<std::mutex> movedLock(movedMutex);
+                movedFlags.push_back(0);
+            }
+            std::unique_lock<std::shared_mutex> slotsLock(locationMutex);
+            driverSlots[driver->getUserId()] = newSlot;
+        } else {
+            driversBySlot[slot->second] = driver;
+            driverTraits[slot->second] = traits;
+            locationStore.addDriver(slot->second, driver->getPosition(), 0, driverZone(driver->getPosition()));
+        }
+        std::uint32_t denseId = driverSlots[driver->getUserId()];
+        if (driver->getStatus() == DriverStatus::AVAILABLE) {
+            idleDrivers.insert(denseId, traits.vehicleType, driver->getPosition());
+        } else {
+            idleDrivers.remove(denseId);
+        }
+        flightRecorder.record(FlightEvent::REGISTER_DRIVER, 0, denseId);
         notifyObservers("USER_REGISTERED", "Driver " + driver->getName() + " registered successfully");
     }
     
+    // Drivers going online/offline. Setting the status on the Driver directly would
+    // leave it out of (or stale in) the idle-driver index dispatch probes.
+    void updateDriverStatus(const std::string& driverId, DriverStatus status) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        auto it = drivers.find(driverId);
+        if (it == drivers.end()) {
+            throw std::runtime_error("Driver not found: " + driverId);
+        }
+        setDriverStatus(it->second, status);
+    }
+    
     // Strategy setters
     void setMatchingStrategy(std::unique_ptr<MatchingStrategy> strategy) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         matchingStrategy = std::move(strategy);
     }
     
     void setPricingCalculator(std::unique_ptr<PricingCalculator> calculator) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         pricingCalculator = std::move(calculator);
     }
     
+    // Normal rides are only offered to drivers within this distance of the pickup
+    void setDispatchRadius(double radiusKm) {
+        if (!(radiusKm > 0.0)) {
+            throw std::invalid_argument("Dispatch radius must be positive");
+        }
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        dispatchRadiusKm = radiusKm;
+    }
+    
+    void setCarpoolMatchingConfig(const CarpoolMatchingConfig& config) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        carpoolPlanner.setConfig(config);
+    }
+    
+    // Well-known places (stations, landmarks, popular pickup points) with stable IDs.
+    // The dictionary has its own lock, so these do not take the engine lock.
+    PlaceId registerPlace(const std::string& name, const Location& location) {
+        GeoPoint point = GeoUtils::toPoint(location);
+        return PlaceDictionary::getInstance().registerPlace(name, point.latitudeE6, point.longitudeE6);
+    }
+    
+    Location getPlaceLocation(const std::string& name) {
+        PlaceDictionary& dictionary = PlaceDictionary::getInstance();
+        PlaceId id = dictionary.findPlace(name);
+        if (id == PlaceDictionary::NO_PLACE) {
+            throw std::runtime_error("Place not found: " + name);
+        }
+        Place place = dictionary.getPlace(id);
+        GeoPoint point{place.latitudeE6, place.longitudeE6};
+        return Location(point.latitude(), point.longitude(), dictionary.getAddress(place.name));
+    }
+    
+    // Live location pipeline. Ingestion and position reads never take the engine
+    // lock, so GPS traffic and dispatch do not block each other: slots and the
+    // clock are read under the shared locationMutex, and the location store never
+    // moves live entries. Driver::setLocation is not seen by matching once a
+    // driver is registered.
+    std::uint32_t getDriverSlot(const std::string& driverId) {
+        std::shared_lock<std::shared_mutex> lock(locationMutex);
+        auto it = driverSlots.find(driverId);
+        if (it == driverSlots.end()) {
+            throw std::runtime_error("Driver not found: " + driverId);
+        }
+        return it->second;
+    }
+    
+    // Each report is tagged with the geofence zone it falls in before it is published
+    void ingestDriverLocations(const std::vector<DriverLocationUpdate>& updates) {
+        RIDEEASY_TRACE_SCOPE("ingestDriverLocations");
+        flightRecorder.record(FlightEvent::LOCATION_BATCH, 0, 0, static_cast<std::uint32_t>(updates.size()));
+        static thread_local std::vector<DriverLocationUpdate> tagged;
+        tagged.assign(updates.begin(), updates.end());
+        for (auto& update : tagged) {
+            update.zoneId = driverZone(update.position);
+        }
+        locationStore.ingest(tagged);
+        trajectories.append(tagged.data(), tagged.size());
+        noteMoved(tagged.data(), tagged.size());
+    }
+    
+    // A zero timestamp means "now" on the engine clock
+    void updateDriverLocation(const std::string& driverId, double latitude, double longitude,
+                              std::int64_t timestampMs = 0) {
+        DriverLocationUpdate update{getDriverSlot(driverId), GeoPoint::fromDegrees(latitude, longitude), timestampMs};
+        if (timestampMs == 0) {
+            update.timestampMs = getCurrentTimeMs();
+        }
+        update.zoneId = driverZone(update.position);
+        flightRecorder.record(FlightEvent::LOCATION_UPDATE, 0, update.driverSlot,
+                              static_cast<std::uint32_t>(update.position.latitudeE6), update.position.longitudeE6);
+        locationStore.ingest(&update, 1);
+        trajectories.append(&update, 1);
+        noteMoved(&update, 1);
+    }
+    
+    // Last reported fix
+    Location getDriverPosition(const std::string& driverId) {
+        return GeoUtils::toLocation(locationStore.read(getDriverSlot(driverId)));
+    }
+    
+    // Position matching uses: the last fix advanced along the driver's velocity
+    Location getPredictedDriverPosition(const std::string& driverId) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        auto it = drivers.find(driverId);
+        if (it == drivers.end()) {
+            throw std::runtime_error("Driver not found: " + driverId);
+        }
+        return GeoUtils::toLocation(driverPosition(it->second));
+    }
+    
+    // Recorded trail between two timestamps (inclusive), for disputes and ETA modelling
+    std::vector<TrajectoryPoint> getDriverTrajectory(const std::string& driverId, std::int64_t fromMs,
+                                                     std::int64_t toMs) {
+        return trajectories.getRange(getDriverSlot(driverId), fromMs, toMs);
+    }
+    
+    std::size_t getTrajectoryMemoryUsage(const std::string& driverId) {
+        return trajectories.getMemoryUsage(getDriverSlot(driverId));
+    }
+    
+    // Dead-reckoning horizon; 0 makes matching use raw last fixes
+    void setPredictionHorizon(std::int64_t horizonMs) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        predictionHorizonMs = std::max<std::int64_t>(0, horizonMs);
+    }
+    
+    // Engine time source (milliseconds); GPS timestamps must use the same clock.
+    // Location updates call it without the engine lock, so it must be thread-safe.
+    void setClock(std::function<std::int64_t()> timeSource) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        if (!timeSource) {
+            throw std::invalid_argument("Clock cannot be empty");
+        }
+        std::lock_guard<std::shared_mutex> clockLock(locationMutex);
+        clock = std::move(timeSource);
+    }
+    
+    // Reseeds the simulated driver acceptance so runs are reproducible
+    void setRandomSeed(std::uint32_t seed) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        acceptanceRng.seed(seed);
+    }
+    
+    std::int64_t getCurrentTimeMs() {
+        std::shared_lock<std::shared_mutex> lock(locationMutex);
+        return clock();
+    }
+    
+    // Geofences: loading publishes a new zone set atomically; drivers pick up their new
+    // zone with their next location report
+    void loadGeofences(const std::string& path) {
+        geofences.loadFromFile(path);
+    }
+    
+    void setGeofences(std::vector<Geofence> zones) {
+        geofences.setZones(std::move(zones));
+    }
+    
+    GeofenceStatus getGeofenceStatus(const Location& location) const {
+        return geofences.query(GeoUtils::toPoint(location));
+    }
+    
+    std::string getZoneName(ZoneId zoneId) const {
+        return geofences.getZoneName(zoneId);
+    }
+    
+    // Carpool batching: CARPOOL requests are queued and grouped once per window on a
+    // worker thread; NORMAL rides keep being matched immediately
+    void enableCarpoolBatching(const CarpoolBatchConfig& config = CarpoolBatchConfig()) {
+        carpoolBatcher.start(config, [this](const std::vector<PendingCarpoolRequest>& batch,
+                                            const std::vector<CarpoolCluster>& clusters) {
+            assignCarpoolBatch(batch, clusters);
+        });
+    }
+    
+    // Solves whatever is still queued, then stops the worker. Must not be called while
+    // holding the engine (e.g. from an observer), since the worker may need it to finish.
+    void disableCarpoolBatching() {
+        carpoolBatcher.stop();
+    }
+    
+    // Solves the queued requests now instead of waiting for the window to close
+    void flushCarpoolBatch() {
+        carpoolBatcher.flush();
+    }
+    
     // Core ride functionality
     std::string requestRide(const std::string& riderId, const Location& pickup,
-                           const Location& dropoff, RideType rideType, VehicleType vehicleType) {
+                           const Location& dropoff, RideType rideType, VehicleType vehicleType,
+                           int passengerCount = 1) {
         
+        auto timer = timeStage(EngineOperation::REQUEST_RIDE); // includes waiting for the engine lock
+        RIDEEASY_TRACE_SCOPE("requestRide");
+        RequestWatch watch(*this);
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         auto rider = riders.find(riderId);
         if (rider == riders.end()) {
             throw std::runtime_error("Rider not found: " + riderId);
         }
         
-        // Validate locations
-        if (pickup.latitude == dropoff.latitude && pickup.longitude == dropoff.longitude) {
+        // Validate locations (compared at the stored, quantized precision)
+        if (GeoUtils::toPoint(pickup) == GeoUtils::toPoint(dropoff)) {
             throw std::invalid_argument("Pickup and dropoff locations cannot be the same");
         }
         
-        std::string rideId = generateRideId();
-        auto ride = std::make_shared<Ride>(rideId, rider->second, pickup, dropoff, rideType, vehicleType);
-        rides[rideId] = ride;
-        
-        notifyObservers("RIDE_REQUESTED", "New ride request: " + rideId + " for " + rider->second->getName());
-        
-        // Find available drivers based on ride type
-        std::vector<std::shared_ptr<Driver>> availableDrivers;
-        for (const auto& driverPair : drivers) {
-            if (rideType == RideType::CARPOOL) {
-                if (canDriverAcceptCarpool(driverPair.second)) {
-                    availableDrivers.push_back(driverPair.second);
-                }
-            } else {
-                if (driverPair.second->getStatus() == DriverStatus::AVAILABLE) {
-                    availableDrivers.push_back(driverPair.second);
-                }
-            }
+        if (passengerCount < 1) {
+            throw std::invalid_argument("Passenger count must be at least 1");
         }
         
-        if (availableDrivers.empty()) {
-            notifyObservers("NO_DRIVER_AVAILABLE", 
-                          "No drivers available for ride " + rideId + ". Please try again later.");
-            return rideId;
+        GeofenceStatus pickupZone = geofences.query(GeoUtils::toPoint(pickup));
+        if (pickupZone.noPickup) {
+            throw std::invalid_argument("Pickups are not allowed at this location (no-pickup zone)");
         }
         
-        // Try to assign driver with improved fallback mechanism
-        bool driverAssigned = false;
-        std::shared_ptr<Driver> assignedDriver = nullptr;
+        std::string rideId = generateRideId();
+        auto ride = std::make_shared<Ride>(rideId, rider->second, pickup, dropoff, rideType, vehicleType,
+                                           static_cast<std::uint32_t>(rideCounter), passengerCount);
+        bool airportPickup = pickupZone.airportZoneId != GeofenceEngine::NO_ZONE;
+        ride->setPickupZone(airportPickup ? pickupZone.airportZoneId : pickupZone.zoneId,
+                            pickupZone.pricingMultiplier, airportPickup);
+        rides[rideId] = ride;
+        ridesRequested[static_cast<int>(rideType)]->add();
+        watch.ride = ride->getDenseId();
+        flightRecorder.record(FlightEvent::REQUEST_RIDE, static_cast<std::uint16_t>(rideType), watch.ride,
+                              static_cast<std::uint32_t>(vehicleType));
         
-        // Attempt assignment with up to 3 drivers
-        int attempts = 0;
-        while (!driverAssigned && !availableDrivers.empty() && attempts < 3) {
-            assignedDriver = matchingStrategy->findBestDriver(availableDrivers, pickup, vehicleType);
-            
-            if (!assignedDriver) {
-                break; // No suitable driver found
-            }
-            
-            // Simulate driver acceptance (85% acceptance rate for first attempt, decreasing)
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_real_distribution<> dis(0.0, 1.0);
-            
-            double acceptanceRate = 0.85 - (attempts * 0.1); // 85%, 75%, 65%
-            
-            if (dis(gen) < acceptanceRate) {
-                ride->assignDriver(assignedDriver);
-                
-                if (rideType == RideType::CARPOOL) {
-                    carpoolRides[assignedDriver->getUserId()].push_back(rideId);
-                    if (assignedDriver->getStatus() == DriverStatus::AVAILABLE) {
-                        assignedDriver->setStatus(DriverStatus::ON_TRIP);
-                    }
-                } else {
-                    assignedDriver->setStatus(DriverStatus::ON_TRIP);
-                }
-                
-                driverAssigned = true;
-                notifyObservers("DRIVER_ASSIGNED", 
-                              "Driver " + assignedDriver->getName() + " assigned to ride " + rideId);
-            } else {
-                notifyObservers("DRIVER_REJECTED", 
-                              "Driver " + assignedDriver->getName() + " rejected ride " + rideId);
-                
-                // Remove this driver from available list and try next
-                availableDrivers.erase(
-                    std::remove(availableDrivers.begin(), availableDrivers.end(), assignedDriver),
-                    availableDrivers.end()
-                );
-                attempts++;
-            }
-        }
+        notifyObservers("RIDE_REQUESTED", "New ride request: " + rideId + " for " + rider->second->getName());
         
-        if (!driverAssigned) {
-            notifyObservers("NO_DRIVER_ASSIGNED", 
-                          "Failed to assign driver for ride " + rideId + " after " + std::to_string(attempts) + " attempts");
+        if (rideType == RideType::CARPOOL && carpoolBatcher.isRunning()) {
+            // Matched with other riders when the current batching window closes
+            carpoolBatcher.submit({rideId, ride->getPickupPoint(), ride->getDropoffPoint(), vehicleType, passengerCount,
+                                   std::chrono::steady_clock::now()});
+            return rideId;
         }
         
+        dispatchRide(ride);
         return rideId;
     }
     
     void updateRideStatus(const std::string& rideId, RideStatus newStatus) {
+        auto timer = timeStage(EngineOperation::UPDATE_RIDE_STATUS);
+        RIDEEASY_TRACE_SCOPE("updateRideStatus");
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         auto rideIt = rides.find(rideId);
         if (rideIt == rides.end()) {
             throw std::runtime_error("Ride not found");
         }
         
         auto ride = rideIt->second;
+        flightRecorder.record(FlightEvent::RIDE_STATUS, static_cast<std::uint16_t>(newStatus), ride->getDenseId(),
+                              static_cast<std::uint32_t>(ride->getStatus()));
         ride->setStatus(newStatus);
         
         std::string statusMessage = "Ride " + rideId + " status updated";
@@ -211,6 +1045,9 @@ public:
             case RideStatus::IN_PROGRESS:
                 statusMessage = "Ride has started";
                 ride->setStartTime();
+                if (ride->getRideType() == RideType::CARPOOL && ride->getDriver()) {
+                    carpoolPlanner.markPickedUp(ride->getDriver()->getUserId(), driverPosition(ride->getDriver()), rideId);
+                }
                 break;
             case RideStatus::COMPLETED:
                 statusMessage = "Ride completed successfully";
@@ -219,8 +1056,11 @@ public:
                 break;
             case RideStatus::CANCELLED:
                 statusMessage = "Ride has been cancelled";
-                if (ride->getDriver()) {
-                    ride->getDriver()->setStatus(DriverStatus::AVAILABLE);
+                ridesCancelled->add();
+                if (ride->getRideType() == RideType::CARPOOL) {
+                    releaseCarpoolSeat(ride); // other pool members keep the driver busy
+                } else if (ride->getDriver()) {
+                    setDriverStatus(ride->getDriver(), DriverStatus::AVAILABLE);
                 }
                 break;
         }
@@ -229,41 +1069,42 @@ public:
     }
     
     void completeRide(const std::string& rideId) {
+        RIDEEASY_TRACE_SCOPE("completeRide");
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         auto rideIt = rides.find(rideId);
         if (rideIt == rides.end()) {
             return;
         }
         
         auto ride = rideIt->second;
-        double distance = calculateDistance(ride->getPickupLocation(), ride->getDropoffLocation());
+        double distance = calculateDistance(ride->getPickupPoint(), ride->getDropoffPoint());
         ride->setDistance(distance);
         
-        double fare = pricingCalculator->calculateFare(distance, ride->getRequestedVehicleType());
-        
-        // Apply carpool discount if applicable
-        if (ride->getRideType() == RideType::CARPOOL) {
-            fare *= 0.8; // 20% carpool discount
+        double fare;
+        {
+            auto timer = timeStage(EngineOperation::PRICING);
+            RIDEEASY_TRACE_SCOPE("pricing");
+            fare = pricingCalculator->calculateFare(distance, ride->getRequestedVehicleType());
+            fare *= ride->getPricingMultiplier(); // special pricing zone at the pickup
+            
+            // Apply carpool discount if applicable
+            if (ride->getRideType() == RideType::CARPOOL) {
+                fare *= 0.8; // 20% carpool discount
+            }
         }
         
         ride->setFare(fare);
+        ridesCompleted->add();
+        flightRecorder.record(FlightEvent::COMPLETE_RIDE, 0, ride->getDenseId(), 0, std::llround(fare * 100.0));
         
         if (ride->getDriver()) {
             auto driver = ride->getDriver();
             
             // Handle carpool cleanup
             if (ride->getRideType() == RideType::CARPOOL) {
-                auto& driverCarpools = carpoolRides[driver->getUserId()];
-                driverCarpools.erase(
-                    std::remove(driverCarpools.begin(), driverCarpools.end(), rideId),
-                    driverCarpools.end()
-                );
-                
-                // If no more carpool rides, set driver to available
-                if (driverCarpools.empty()) {
-                    driver->setStatus(DriverStatus::AVAILABLE);
-                }
+                releaseCarpoolSeat(ride);
             } else {
-                driver->setStatus(DriverStatus::AVAILABLE);
+                setDriverStatus(driver, DriverStatus::AVAILABLE);
             }
         }
         
@@ -271,12 +1112,33 @@ public:
                       "Payment of Rs." + std::to_string(fare) + " completed for ride " + rideId);
     }
     
+    // Hides Subject::notifyObservers so every engine notification is timed
+    void notifyObservers(const std::string& event, const std::string& message) {
+        auto timer = timeStage(EngineOperation::NOTIFICATION);
+        RIDEEASY_TRACE_SCOPE("notifyObservers");
+        notificationsSent->add();
+        notificationsInFlight->add(1);
+        struct LeaveQueue {
+            MetricGauge* depth;
+            ~LeaveQueue() { depth->add(-1); }
+        } leave{notificationsInFlight};
+        Subject::notifyObservers(event, message);
+    }
+    
     std::shared_ptr<Ride> getRide(const std::string& rideId) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         auto it = rides.find(rideId);
         return (it != rides.end()) ? it->second : nullptr;
     }
     
+    // Pending stops of a carpool driver in driving order (empty when not pooling)
+    std::vector<RouteStop> getCarpoolRoute(const std::string& driverId) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        return carpoolPlanner.getRoute(driverId);
+    }
+    
     std::vector<std::shared_ptr<Driver>> getAvailableDrivers() {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         std::vector<std::shared_ptr<Driver>> available;
         for (const auto& driverPair : drivers) {
             if (driverPair.second->getStatus() == DriverStatus::AVAILABLE) {
@@ -286,8 +1148,61 @@ public:
         return available;
     }
     
+    // Latency percentiles of one engine stage since construction or the last reset;
+    // lock-free, so it can be polled while other threads keep recording
+    LatencySummary getLatencySummary(EngineOperation operation) const {
+        return latencies.snapshot(static_cast<std::size_t>(operation)).summarize();
+    }
+    
+    void resetLatencyStats() {
+        latencies.reset();
+    }
+    
+    // Rolling match telemetry per (vehicle type, pickup zone) over the window
+    // ending now on the engine clock, busiest first. Covers every dispatch;
+    // carpool riders seated as a whole batch group are not individual matches.
+    std::vector<MatchSummary> getMatchSummaries() {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        return matchTelemetry.summaries(clock());
+    }
+    
+    // Same, for the window ending at the given engine time (e.g. the end of a simulated demand period)
+    std::vector<MatchSummary> getMatchSummaries(std::int64_t windowEndMs) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        return matchTelemetry.summaries(windowEndMs);
+    }
+    
+    // Window length and slice count of the rolling summaries (clears them)
+    void setMatchTelemetryWindow(std::int64_t windowMs, std::size_t slices) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        matchTelemetry.configure(windowMs, slices);
+    }
+    
+    // Called with every dispatch's record, under the engine lock
+    void setMatchTelemetryListener(std::function<void(const MatchRecord&)> listener) {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
+        matchListener = std::move(listener);
+    }
+    
+    // A requestRide taking longer than this (lock wait included) triggers a
+    // flight recorder anomaly, dumped if FlightRecorder::setAnomalyDump is set; 0 disables
+    void setSlowRequestThresholdUs(std::int64_t thresholdUs) {
+        slowRequestNs.store(std::max<std::int64_t>(0, thresholdUs) * 1000, std::memory_order_relaxed);
+    }
+    
+    // Counters, gauges and stage histograms in Prometheus text format (render() or writeToFile())
+    MetricsRegistry& getMetrics() {
+        return metrics;
+    }
+    
+    static const char* getOperationName(EngineOperation operation) {
+        static const char* const names[] = {"requestRide", "matching", "pricing", "notification", "updateRideStatus"};
+        return names[static_cast<std::size_t>(operation)];
+    }
+    
     // Enhanced status reporting
     std::vector<std::string> getSystemStatus() {
+        std::lock_guard<std::recursive_mutex> lock(engineMutex);
         std::vector<std::string> status;
         
         int availableDrivers = 0;
@@ -307,7 +1222,8 @@ public:
         status.push_back("On Trip: " + std::to_string(onTripDrivers));
         status.push_back("Offline: " + std::to_string(offlineDrivers));
         status.push_back("Total Rides: " + std::to_string(rides.size()));
-        status.push_back("Active Carpool Groups: " + std::to_string(carpoolRides.size()));
+        status.push_back("Active Carpool Groups: " + std::to_string(carpoolMembership.getActiveGroupCount()));
+        status.push_back("Geofence Zones: " + std::to_string(geofences.getZoneCount()));
         
         return status;
     }
@@ -0,0 +1,153 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+#include <stdexcept>
+#include <cstdint>
+
+// Scoped tracing spans, compiled in only with RIDEEASY_ENABLE_TRACING (CMake
+// option of the same name). Each thread appends finished spans to its own
+// fixed-size ring without locking, overwriting its oldest spans once full, so
+// a trace always ends with the most recent activity. The collector keeps every
+// ring alive after its thread exits and exports all of them as Chrome
+// trace-event JSON (chrome://tracing, Perfetto). Export once recording has
+// stopped: a span being overwritten meanwhile may come out torn. Span names
+// must be string literals.
+struct TraceSpanRecord {
+    const char* name;
+    std::int64_t startNs; // since the collector's epoch
+    std::int64_t durationNs;
+};
+
+class TraceCollector {
+public:
+    static constexpr std::size_t EVENTS_PER_THREAD = 1 << 16;
+
+private:
+    // Written only by its thread; `head` publishes finished records to exporters
+    struct ThreadBuffer {
+        std::uint32_t threadId;
+        std::vector<TraceSpanRecord> events;
+        std::atomic<std::uint64_t> head{0}; // spans ever recorded; the newest EVENTS_PER_THREAD are kept
+
+        explicit ThreadBuffer(std::uint32_t threadId) : threadId(threadId), events(EVENTS_PER_THREAD) {}
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex buffersMutex; // registration and export only
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    TraceCollector() : epoch(std::chrono::steady_clock::now()) {}
+
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<std::uint32_t>(buffers.size() + 1)));
+            buffer = buffers.back().get();
+        }
+        return *buffer;
+    }
+
+public:
+    static TraceCollector& instance() {
+        static TraceCollector collector;
+        return collector;
+    }
+
+    std::int64_t nowNs() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(const char* name, std::int64_t startNs, std::int64_t endNs) {
+        ThreadBuffer& buffer = threadBuffer();
+        std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        buffer.events[head % EVENTS_PER_THREAD] = {name, startNs, endNs - startNs};
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    // Spans overwritten by newer ones on the same thread
+    std::uint64_t getDroppedCount() {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        std::uint64_t dropped = 0;
+        for (const auto& buffer : buffers) {
+            std::uint64_t head = buffer->head.load(std::memory_order_relaxed);
+            dropped += head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+        }
+        return dropped;
+    }
+
+    // Forgets recorded spans; only safe while no thread is recording
+    void clear() {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers) {
+            buffer->head.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Complete ("X") events, one track per recording thread; times in microseconds
+    void writeChromeJson(std::ostream& output) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        output << std::fixed << std::setprecision(3);
+        bool first = true;
+        for (const auto& buffer : buffers) {
+            std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+            std::uint64_t oldest = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+            for (std::uint64_t i = oldest; i < head; i++) {
+                const TraceSpanRecord& event = buffer->events[i % EVENTS_PER_THREAD];
+                output << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name
+                       << "\",\"cat\":\"rideeasy\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                       << ",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+                first = false;
+            }
+        }
+        output << "\n]}\n";
+    }
+
+    void saveChromeJson(const std::string& path) {
+        std::ofstream output(path);
+        if (!output) {
+            throw std::runtime_error("Cannot write trace: " + path);
+        }
+        writeChromeJson(output);
+    }
+};
+
+class TraceSpan {
+private:
+    const char* name;
+    std::int64_t startNs;
+
+public:
+    explicit TraceSpan(const char* name) : name(name), startNs(TraceCollector::instance().nowNs()) {}
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    ~TraceSpan() {
+        TraceCollector& collector = TraceCollector::instance();
+        collector.record(name, startNs, collector.nowNs());
+    }
+};
+
+#define RIDEEASY_TRACE_CONCAT_INNER(a, b) a##b
+#define RIDEEASY_TRACE_CONCAT(a, b) RIDEEASY_TRACE_CONCAT_INNER(a, b)
+
+#ifdef RIDEEASY_ENABLE_TRACING
+#define RIDEEASY_TRACING_ENABLED true
+#define RIDEEASY_TRACE_SCOPE(name) TraceSpan RIDEEASY_TRACE_CONCAT(traceSpan, __LINE__)(name)
+#else
+#define RIDEEASY_TRACING_ENABLED false
+#define RIDEEASY_TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif
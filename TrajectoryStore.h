@@ -0,0 +1,198 @@
+#ifndef TRAJECTORY_STORE_H
+#define TRAJECTORY_STORE_H
+
+#include "User.h"
+#include "DriverLocationStore.h"
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+struct TrajectoryConfig {
+    std::size_t pointsPerBlock = 128; // GPS points encoded per block
+    std::size_t maxBlocks = 16;       // blocks kept per driver; the oldest is recycled
+};
+
+struct TrajectoryPoint {
+    std::int64_t timestampMs;
+    GeoPoint position;
+};
+
+// Recent GPS trail of every driver, compressed. Points are written into blocks
+// as zigzag varints of (time, latitude, longitude) deltas from the previous
+// point, so a driver moving normally costs a few bytes per fix instead of a
+// full Location. Each driver keeps a ring of blocks: appending is O(1) and,
+// once the ring is full, starting a new block recycles the oldest one. Blocks
+// remember their time span, so range reads decode only overlapping blocks.
+class TrajectoryStore {
+private:
+    struct Block {
+        std::vector<std::uint8_t> bytes;
+        std::size_t count = 0;
+        std::int64_t minTimestampMs = 0;
+        std::int64_t maxTimestampMs = 0;
+        TrajectoryPoint last{0, GeoPoint()}; // delta base for the next point
+    };
+
+    struct DriverTrail {
+        std::vector<Block> blocks; // ring, at most maxBlocks entries
+        std::size_t newest = 0;    // index of the block being appended to
+        std::size_t pointCount = 0;
+        std::int64_t lastTimestampMs = std::numeric_limits<std::int64_t>::min();
+    };
+
+    TrajectoryConfig config;
+    std::vector<DriverTrail> trails; // indexed by dense driver ID
+    mutable std::mutex storeMutex;
+
+    static std::uint64_t zigzag(std::int64_t value) {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    static std::int64_t unzigzag(std::uint64_t value) {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    static void putVarint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    static std::uint64_t getVarint(const std::uint8_t*& in) {
+        std::uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            std::uint8_t byte = *in++;
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    }
+
+    // Caller holds storeMutex. A fix no newer than the last one arrived late or out
+    // of order and is dropped, as in DriverLocationStore, so blocks stay in time order.
+    void appendLocked(std::uint32_t slot, const TrajectoryPoint& point) {
+        DriverTrail& trail = trails[slot];
+        if (point.timestampMs <= trail.lastTimestampMs) {
+            return;
+        }
+        trail.lastTimestampMs = point.timestampMs;
+        if (trail.blocks.empty() || trail.blocks[trail.newest].count == config.pointsPerBlock) {
+            if (trail.blocks.size() < config.maxBlocks) {
+                trail.blocks.emplace_back();
+                trail.newest = trail.blocks.size() - 1;
+            } else {
+                trail.newest = (trail.newest + 1) % trail.blocks.size();
+                trail.pointCount -= trail.blocks[trail.newest].count;
+            }
+            Block& recycled = trail.blocks[trail.newest];
+            recycled.bytes.clear(); // keeps its capacity
+            recycled.count = 0;
+            recycled.last = TrajectoryPoint{0, GeoPoint()};
+            recycled.minTimestampMs = std::numeric_limits<std::int64_t>::max();
+            recycled.maxTimestampMs = std::numeric_limits<std::int64_t>::min();
+        }
+
+        Block& block = trail.blocks[trail.newest];
+        putVarint(block.bytes, zigzag(point.timestampMs - block.last.timestampMs));
+        putVarint(block.bytes, zigzag(static_cast<std::int64_t>(point.position.latitudeE6) -
+                                      block.last.position.latitudeE6));
+        putVarint(block.bytes, zigzag(static_cast<std::int64_t>(point.position.longitudeE6) -
+                                      block.last.position.longitudeE6));
+        block.last = point;
+        block.count++;
+        block.minTimestampMs = std::min(block.minTimestampMs, point.timestampMs);
+        block.maxTimestampMs = std::max(block.maxTimestampMs, point.timestampMs);
+        trail.pointCount++;
+    }
+
+    static void decode(const Block& block, std::int64_t fromMs, std::int64_t toMs,
+                       std::vector<TrajectoryPoint>& out) {
+        const std::uint8_t* in = block.bytes.data();
+        TrajectoryPoint point{0, GeoPoint()};
+        for (std::size_t i = 0; i < block.count; i++) {
+            point.timestampMs += unzigzag(getVarint(in));
+            point.position.latitudeE6 += static_cast<std::int32_t>(unzigzag(getVarint(in)));
+            point.position.longitudeE6 += static_cast<std::int32_t>(unzigzag(getVarint(in)));
+            if (point.timestampMs >= fromMs && point.timestampMs <= toMs) {
+                out.push_back(point);
+            }
+        }
+    }
+
+public:
+    TrajectoryStore(const TrajectoryConfig& config = TrajectoryConfig()) : config(config) {
+        if (config.pointsPerBlock == 0 || config.maxBlocks == 0) {
+            throw std::invalid_argument("Trajectory blocks must hold at least one point");
+        }
+    }
+
+    // Registers a driver slot; reports for unknown slots are ignored
+    void addDriver(std::uint32_t slot) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        if (slot >= trails.size()) {
+            trails.resize(slot + 1);
+        }
+    }
+
+    void append(std::uint32_t slot, std::int64_t timestampMs, const GeoPoint& position) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        if (slot < trails.size()) {
+            appendLocked(slot, TrajectoryPoint{timestampMs, position});
+        }
+    }
+
+    void append(const DriverLocationUpdate* updates, std::size_t count) {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        for (std::size_t i = 0; i < count; i++) {
+            if (updates[i].driverSlot < trails.size()) {
+                appendLocked(updates[i].driverSlot, TrajectoryPoint{updates[i].timestampMs, updates[i].position});
+            }
+        }
+    }
+
+    // Points with fromMs <= timestamp <= toMs, oldest block first
+    std::vector<TrajectoryPoint> getRange(std::uint32_t slot, std::int64_t fromMs, std::int64_t toMs) const {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        std::vector<TrajectoryPoint> points;
+        if (slot >= trails.size() || trails[slot].blocks.empty()) {
+            return points;
+        }
+        const DriverTrail& trail = trails[slot];
+        std::size_t blockCount = trail.blocks.size();
+        for (std::size_t i = 1; i <= blockCount; i++) {
+            const Block& block = trail.blocks[(trail.newest + i) % blockCount];
+            if (block.count > 0 && block.maxTimestampMs >= fromMs && block.minTimestampMs <= toMs) {
+                decode(block, fromMs, toMs, points);
+            }
+        }
+        return points;
+    }
+
+    std::size_t getPointCount(std::uint32_t slot) const {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        return slot < trails.size() ? trails[slot].pointCount : 0;
+    }
+
+    // Heap and inline bytes held for one driver's trail
+    std::size_t getMemoryUsage(std::uint32_t slot) const {
+        std::lock_guard<std::mutex> lock(storeMutex);
+        if (slot >= trails.size()) {
+            return 0;
+        }
+        const DriverTrail& trail = trails[slot];
+        std::size_t bytes = sizeof(DriverTrail) + trail.blocks.capacity() * sizeof(Block);
+        for (const auto& block : trail.blocks) {
+            bytes += block.bytes.capacity();
+        }
+        return bytes;
+    }
+};
+
+#endif
@@ -1,8 +1,11 @@
 #ifndef USER_H
 #define USER_H
 
+#include "PlaceDictionary.h"
 #include <string>
 #include <memory>
+#include <cmath>
+#include <cstdint>
 
 struct Location {
     double latitude;
@@ -13,6 +16,56 @@ struct Location {
         : latitude(lat), longitude(lng), address(addr) {}
 };
 
+// Quantized coordinates used for all spatial work: int32 micro-degrees
+// (~0.1 m resolution) in 8 bytes, so coordinate arrays pack densely
+struct GeoPoint {
+    static constexpr double UNITS_PER_DEGREE = 1e6;
+    
+    std::int32_t latitudeE6 = 0;
+    std::int32_t longitudeE6 = 0;
+    
+    static std::int32_t toUnits(double degrees) {
+        return static_cast<std::int32_t>(std::lround(degrees * UNITS_PER_DEGREE));
+    }
+    
+    static GeoPoint fromDegrees(double latitude, double longitude) {
+        return GeoPoint{toUnits(latitude), toUnits(longitude)};
+    }
+    
+    double latitude() const { return latitudeE6 / UNITS_PER_DEGREE; }
+    double longitude() const { return longitudeE6 / UNITS_PER_DEGREE; }
+    
+    bool operator==(const GeoPoint& other) const {
+        return latitudeE6 == other.latitudeE6 && longitudeE6 == other.longitudeE6;
+    }
+    bool operator!=(const GeoPoint& other) const { return !(*this == other); }
+};
+
+static_assert(sizeof(GeoPoint) == 8, "GeoPoint must stay two packed int32 values");
+
+// Stored form of a Location: quantized point plus the address, as the 4-byte ID
+// of a registered place name or, for any other text, inline
+struct CompactLocation {
+    GeoPoint point;
+    AddressId address = PlaceDictionary::NO_ADDRESS;
+    std::string freeformAddress; // empty when `address` names it
+    
+    CompactLocation() = default;
+    CompactLocation(const Location& location)
+        : point(GeoPoint::fromDegrees(location.latitude, location.longitude)),
+          address(PlaceDictionary::getInstance().findAddress(location.address)) {
+        if (address == PlaceDictionary::NO_ADDRESS) {
+            freeformAddress = location.address;
+        }
+    }
+    
+    Location toLocation() const {
+        return Location(point.latitude(), point.longitude(),
+                        address != PlaceDictionary::NO_ADDRESS ? PlaceDictionary::getInstance().getAddress(address)
+                                                               : freeformAddress);
+    }
+};
+
 // Base User class following Single Responsibility Principle
 class User {
 protected:
@@ -35,7 +88,7 @@ public:
 
 class Rider : public User {
 private:
-    Location defaultPickupLocation;
+    CompactLocation defaultPickupLocation;
     double rating;
     
 public:
@@ -43,7 +96,8 @@ public:
           const Location& defaultLocation = Location())
         : User(id, name, phone), defaultPickupLocation(defaultLocation), rating(5.0) {}
     
-    const Location& getDefaultPickupLocation() const { return defaultPickupLocation; }
+    Location getDefaultPickupLocation() const { return defaultPickupLocation.toLocation(); }
+    const GeoPoint& getDefaultPickupPoint() const { return defaultPickupLocation.point; }
     double getRating() const { return rating; }
     void setRating(double newRating) { rating = newRating; }
 };
@@ -69,7 +123,7 @@ struct Vehicle {
 class Driver : public User {
 private:
     Vehicle vehicle;
-    Location currentLocation;
+    CompactLocation currentLocation;
     DriverStatus status;
     double rating;
     
@@ -80,7 +134,8 @@ public:
           status(DriverStatus::AVAILABLE), rating(5.0) {}
     
     const Vehicle& getVehicle() const { return vehicle; }
-    const Location& getCurrentLocation() const { return currentLocation; }
+    Location getCurrentLocation() const { return currentLocation.toLocation(); }
+    const GeoPoint& getPosition() const { return currentLocation.point; }
     DriverStatus getStatus() const { return status; }
     double getRating() const { return rating; }
     
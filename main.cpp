@@ -179,7 +179,7 @@ void simulateAdvancedScenarios() {
     rideManager.setMatchingStrategy(std::make_unique<BestRatedDriverStrategy>());
     
     // Reset driver status for demonstration
-    driver1->setStatus(DriverStatus::AVAILABLE);
+    rideManager.updateDriverStatus(driver1->getUserId(), DriverStatus::AVAILABLE);
     
     std::string ratedRide = rideManager.requestRide("R004",
                                                    Location(19.0825, 72.8231, "Santacruz"),
@@ -201,7 +201,7 @@ void simulateAdvancedScenarios() {
     rideManager.setPricingCalculator(std::move(combinedPricing));
     
     // Reset another driver
-    driver2->setStatus(DriverStatus::AVAILABLE);
+    rideManager.updateDriverStatus(driver2->getUserId(), DriverStatus::AVAILABLE);
     
     std::string complexPricingRide = rideManager.requestRide("R001",
                                                             Location(19.0760, 72.8777, "Andheri"),
@@ -238,7 +238,7 @@ void simulateAdvancedScenarios() {
     // Test high demand scenario
     std::cout << "[EDGE CASE] Testing high demand - all drivers busy" << std::endl;
     for (auto driver : {driver1, driver2, driver3, driver4}) {
-        driver->setStatus(DriverStatus::OFFLINE);
+        rideManager.updateDriverStatus(driver->getUserId(), DriverStatus::OFFLINE);
     }
     
     std::string noDriveRide = rideManager.requestRide("R003",
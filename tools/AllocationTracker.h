@@ -0,0 +1,127 @@
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+// Heap allocation accounting for benchmarks. With RIDEEASY_TRACK_ALLOCATIONS
+// (CMake option of the same name) this header replaces the global operator
+// new/delete, so it must be included by exactly one translation unit per
+// executable; every tool is a single file, so that is the tool's main file.
+// Counts are kept per thread and read through ScopedAllocationCounter.
+// Over-aligned allocations (operator new with std::align_val_t) are not counted.
+struct AllocationCounts {
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t frees = 0;
+
+    AllocationCounts operator-(const AllocationCounts& earlier) const {
+        return {allocations - earlier.allocations, bytes - earlier.bytes, frees - earlier.frees};
+    }
+
+    AllocationCounts& operator+=(const AllocationCounts& other) {
+        allocations += other.allocations;
+        bytes += other.bytes;
+        frees += other.frees;
+        return *this;
+    }
+};
+
+class AllocationTracker {
+public:
+#ifdef RIDEEASY_TRACK_ALLOCATIONS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+
+    // Constant-initialized, so the hooks may touch it at any point of a thread's life
+    static AllocationCounts& threadCounts() {
+        static thread_local AllocationCounts counts;
+        return counts;
+    }
+};
+
+// Allocations made by the current thread since construction (zero when not tracking)
+class ScopedAllocationCounter {
+private:
+    AllocationCounts start;
+
+public:
+    ScopedAllocationCounter() : start(AllocationTracker::threadCounts()) {}
+
+    AllocationCounts delta() const {
+        return AllocationTracker::threadCounts() - start;
+    }
+};
+
+#ifdef RIDEEASY_TRACK_ALLOCATIONS
+
+// GCC sees the malloc/free pairing through inlined new/delete and flags it
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    AllocationCounts& counts = AllocationTracker::threadCounts();
+    counts.allocations++;
+    counts.bytes += size;
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory) {
+        AllocationTracker::threadCounts().frees++;
+        std::free(memory);
+    }
+}
+
+void operator delete[](void* memory) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    ::operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    ::operator delete(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+#endif
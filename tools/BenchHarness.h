@@ -0,0 +1,261 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include "AllocationTracker.h"
+#include "PerfCounters.h"
+#include <vector>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <iomanip>
+#include <cstdint>
+
+struct BenchParams {
+    std::string variant;       // e.g. decorator/compiled, legacy/positions
+    std::size_t drivers = 0;   // registered fleet size, 0 if not applicable
+    std::size_t observers = 0; // observers attached to the engine
+};
+
+struct BenchResult {
+    std::string name;
+    BenchParams params;
+    std::uint64_t operations = 0;
+    double seconds = 0.0; // timed part only
+    AllocationCounts allocations; // timed part only, when allocation tracking is compiled in
+    PerfSample perf;              // timed part only, when hardware counters are enabled
+
+    double nsPerOp() const { return operations > 0 ? seconds * 1e9 / operations : 0.0; }
+    double opsPerSecond() const { return seconds > 0 ? operations / seconds : 0.0; }
+    double allocationsPerOp() const { return operations > 0 ? static_cast<double>(allocations.allocations) / operations : 0.0; }
+    double bytesPerOp() const { return operations > 0 ? static_cast<double>(allocations.bytes) / operations : 0.0; }
+    double perfPerOp(PerfEvent event) const { return operations > 0 ? static_cast<double>(perf[event]) / operations : 0.0; }
+};
+
+// Start of a body's timed part: BenchHarness::mark() ... BenchHarness::elapsedNs(mark)
+struct BenchMark {
+    std::chrono::steady_clock::time_point time;
+    ScopedAllocationCounter allocations;
+    PerfSample perf;
+};
+
+// Keeps a computed value alive so the optimizer cannot drop the work behind it
+template <typename T>
+inline void benchKeep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+// Minimal micro-benchmark runner. A body is called as body(operations) and
+// returns the nanoseconds its timed part took, so untimed setup and cleanup
+// (e.g. completing the rides a requestRide benchmark created) stay out of the
+// measurement. Operation counts double until one call takes a tenth of the
+// minimum time, then calls repeat until the minimum time is reached. Bodies
+// with expensive untimed setup stop early once ten times the minimum time has
+// passed on the wall clock. Timed parts bracketed by mark()/elapsedNs(mark)
+// also have their heap allocations and, once enableHardwareCounters()
+// succeeded, their hardware counter deltas attributed to the benchmark.
+class BenchHarness {
+private:
+    double minSeconds;
+    std::string filter;
+    std::vector<BenchResult> results;
+    std::unique_ptr<PerfCounters> perfCounters;
+
+    // Totals of the timed parts since the last reset (benchmarks run on one thread)
+    static AllocationCounts& sectionAllocations() {
+        static AllocationCounts counts;
+        return counts;
+    }
+
+    static PerfSample& sectionPerf() {
+        static PerfSample sample;
+        return sample;
+    }
+
+    static std::uint64_t& sectionPerfSamples() {
+        static std::uint64_t samples = 0;
+        return samples;
+    }
+
+    // Counters read by mark()/elapsedNs(), null unless enabled
+    static PerfCounters*& activePerfCounters() {
+        static PerfCounters* counters = nullptr;
+        return counters;
+    }
+
+    // An event stays present only while every sample has it: a total that missed
+    // some samples would be divided by all of the benchmark's operations
+    static void addPerf(PerfSample& total, std::uint64_t& samples, const PerfSample& delta) {
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+            total.values[i] += delta.values[i];
+            total.present[i] = (samples == 0 || total.present[i]) && delta.present[i];
+        }
+        samples++;
+    }
+
+    static const char* perfName(std::size_t event) {
+        static const char* const names[PERF_EVENT_COUNT] = {"cycles", "instructions", "cache_misses",
+                                                            "branch_misses"};
+        return names[event];
+    }
+
+    static std::string jsonEscape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+public:
+    BenchHarness(double minSeconds = 0.2, const std::string& filter = "")
+        : minSeconds(minSeconds), filter(filter) {}
+
+    BenchHarness(const BenchHarness&) = delete;
+    BenchHarness& operator=(const BenchHarness&) = delete;
+
+    ~BenchHarness() {
+        if (perfCounters && activePerfCounters() == perfCounters.get()) {
+            activePerfCounters() = nullptr;
+        }
+    }
+
+    // Opens cycles, instructions, cache-miss and branch-miss counters for this
+    // thread; returns an empty string on success, else why they are unavailable
+    std::string enableHardwareCounters() {
+        perfCounters = std::make_unique<PerfCounters>();
+        if (!perfCounters->available()) {
+            std::string error = perfCounters->getError();
+            perfCounters.reset();
+            return error;
+        }
+        activePerfCounters() = perfCounters.get();
+        return "";
+    }
+
+    bool hardwareCountersEnabled() const { return perfCounters != nullptr; }
+
+    // Benchmarks whose name does not contain the filter are skipped
+    bool enabled(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    static std::int64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static BenchMark mark() {
+        BenchMark start; // the allocation counter starts here
+        if (PerfCounters* counters = activePerfCounters()) {
+            start.perf = counters->read();
+        }
+        start.time = std::chrono::steady_clock::now();
+        return start;
+    }
+
+    static std::int64_t elapsedNs(const BenchMark& start) {
+        std::int64_t ns = elapsedNs(start.time);
+        if (PerfCounters* counters = activePerfCounters()) {
+            addPerf(sectionPerf(), sectionPerfSamples(), counters->read() - start.perf);
+        }
+        sectionAllocations() += start.allocations.delta();
+        return ns;
+    }
+
+    template <typename Body>
+    const BenchResult* run(const std::string& name, const BenchParams& params, Body&& body) {
+        if (!enabled(name)) {
+            return nullptr;
+        }
+        auto wallStart = std::chrono::steady_clock::now();
+        double wallLimitNs = minSeconds * 1e10;
+        std::uint64_t batch = 1;
+        while (body(batch) < minSeconds * 1e8 && batch < (1ull << 40) && elapsedNs(wallStart) < wallLimitNs / 2) {
+            batch *= 2;
+        }
+
+        BenchResult result{name, params, 0, 0.0, AllocationCounts(), PerfSample()};
+        sectionAllocations() = AllocationCounts();
+        sectionPerf() = PerfSample();
+        sectionPerfSamples() = 0;
+        double totalNs = 0.0;
+        while (totalNs < minSeconds * 1e9 && (result.operations == 0 || elapsedNs(wallStart) < wallLimitNs)) {
+            totalNs += static_cast<double>(body(batch));
+            result.operations += batch;
+        }
+        result.seconds = totalNs / 1e9;
+        result.allocations = sectionAllocations();
+        result.perf = sectionPerf();
+        results.push_back(result);
+        return &results.back();
+    }
+
+    const std::vector<BenchResult>& getResults() const { return results; }
+
+    // One JSON object per line
+    void writeJson(std::ostream& output) const {
+        output << std::fixed << std::setprecision(2);
+        for (const auto& result : results) {
+            output << "{\"benchmark\":\"" << jsonEscape(result.name) << "\",\"variant\":\""
+                   << jsonEscape(result.params.variant) << "\",\"drivers\":" << result.params.drivers
+                   << ",\"observers\":" << result.params.observers << ",\"operations\":" << result.operations
+                   << ",\"ns_per_op\":" << result.nsPerOp() << ",\"ops_per_sec\":" << result.opsPerSecond();
+            if (AllocationTracker::enabled) {
+                output << ",\"allocs_per_op\":" << result.allocationsPerOp()
+                       << ",\"bytes_per_op\":" << result.bytesPerOp();
+            }
+            if (hardwareCountersEnabled()) {
+                for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+                    if (result.perf.present[i]) {
+                        output << ",\"" << perfName(i) << "_per_op\":" << result.perfPerOp(static_cast<PerfEvent>(i));
+                    }
+                }
+                if (result.perf.has(PerfEvent::CYCLES) && result.perf.has(PerfEvent::INSTRUCTIONS) &&
+                    result.perf[PerfEvent::CYCLES] > 0) {
+                    output << ",\"ipc\":"
+                           << static_cast<double>(result.perf[PerfEvent::INSTRUCTIONS]) / result.perf[PerfEvent::CYCLES];
+                }
+            }
+            output << "}\n";
+        }
+    }
+
+    void writeCsv(std::ostream& output) const {
+        output << "benchmark,variant,drivers,observers,operations,ns_per_op,ops_per_sec"
+               << (AllocationTracker::enabled ? ",allocs_per_op,bytes_per_op" : "");
+        if (hardwareCountersEnabled()) {
+            for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+                output << ',' << perfName(i) << "_per_op";
+            }
+        }
+        output << '\n';
+        output << std::fixed << std::setprecision(2);
+        for (const auto& result : results) {
+            output << result.name << ',' << result.params.variant << ',' << result.params.drivers << ','
+                   << result.params.observers << ',' << result.operations << ',' << result.nsPerOp() << ','
+                   << result.opsPerSecond();
+            if (AllocationTracker::enabled) {
+                output << ',' << result.allocationsPerOp() << ',' << result.bytesPerOp();
+            }
+            if (hardwareCountersEnabled()) {
+                for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+                    output << ','; // empty when the event could not be counted
+                    if (result.perf.present[i]) {
+                        output << result.perfPerOp(static_cast<PerfEvent>(i));
+                    }
+                }
+            }
+            output << '\n';
+        }
+    }
+};
+
+#endif
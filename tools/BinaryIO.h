@@ -0,0 +1,123 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+
+// Little-endian fixed-width integers, varints and zigzag varints, shared by
+// the tool file formats (workloads, traces)
+class ByteWriter {
+private:
+    std::vector<std::uint8_t> out;
+
+public:
+    void reserve(std::size_t bytes) { out.reserve(bytes); }
+
+    void raw(const char* data, std::size_t size) {
+        out.insert(out.end(), data, data + size);
+    }
+
+    void fixed(std::uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void signedVarint(std::int64_t value) {
+        varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void string(const std::string& value) {
+        varint(value.size());
+        raw(value.data(), value.size());
+    }
+
+    const std::vector<std::uint8_t>& bytes() const { return out; }
+    std::vector<std::uint8_t> release() { return std::move(out); }
+
+    static void saveFile(const std::vector<std::uint8_t>& bytes, const std::string& path) {
+        std::ofstream output(path, std::ios::binary);
+        if (!output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            throw std::runtime_error("Cannot write file: " + path);
+        }
+    }
+};
+
+// Bounds-checked cursor; every read past the end throws "<what> is truncated"
+class ByteReader {
+private:
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t offset;
+    std::string what;
+
+public:
+    ByteReader(const std::vector<std::uint8_t>& bytes, std::string what, std::size_t offset = 0)
+        : data(bytes.data()), size(bytes.size()), offset(offset), what(std::move(what)) {}
+
+    static std::vector<std::uint8_t> loadFile(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        if (!input) {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    }
+
+    std::size_t remaining() const { return size - offset; }
+
+    void need(std::size_t bytes) const {
+        if (size - offset < bytes) {
+            throw std::runtime_error(what + " is truncated");
+        }
+    }
+
+    std::uint64_t fixed(int bytes) {
+        need(bytes);
+        std::uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<std::uint64_t>(data[offset++]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            need(1);
+            std::uint8_t byte = data[offset++];
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error(what + " has a malformed varint");
+    }
+
+    std::int64_t signedVarint() {
+        std::uint64_t value = varint();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::string string() {
+        std::uint64_t length = varint();
+        need(length);
+        std::string value(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return value;
+    }
+};
+
+#endif
@@ -0,0 +1,450 @@
+#ifndef CITY_SIMULATOR_H
+#define CITY_SIMULATOR_H
+
+#include "RideManager.h"
+#include "Workload.h"
+#include "Trace.h"
+#include "GeoUtils.h"
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <string>
+#include <random>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+struct SimulationConfig {
+    std::uint64_t seed = 42;
+    double speedKmh = 25.0;              // average city driving speed
+    std::int64_t gpsIntervalMs = 10000;  // every driver reports this often; 0 disables GPS
+    std::int64_t startTimeMs = 1704067200000; // virtual epoch (2024-01-01 00:00 UTC)
+};
+
+struct SimulationReport {
+    std::size_t ridesRequested = 0;
+    std::size_t ridesAssigned = 0;
+    std::size_t ridesCompleted = 0;
+    std::size_t ridesUnserved = 0; // no driver found; the rider cancels
+    std::size_t ridesRejected = 0; // requestRide threw (e.g. no-pickup zone)
+    std::size_t locationUpdates = 0;
+    std::size_t events = 0;
+    double totalFare = 0.0;
+    double totalPickupKm = 0.0;
+    double totalWaitSeconds = 0.0;
+    double driverBusySeconds = 0.0; // assignment to dropoff, overlapping carpool rides counted once
+    std::size_t drivers = 0;
+    double simulatedSeconds = 0.0;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;        // CPU time of the simulating thread
+
+    // Share of fleet time spent serving rides
+    double utilization() const {
+        return drivers > 0 && simulatedSeconds > 0 ? driverBusySeconds / (drivers * simulatedSeconds) : 0.0;
+    }
+};
+
+// Discrete-event simulation of a city on top of RideManager. Virtual time jumps
+// from event to event (ride requests, pickups, drop-offs, GPS rounds) and is
+// installed as the engine clock, so nothing ever sleeps. Drivers travel in
+// straight lines at a fixed speed; each assigned ride goes ENROUTE at once,
+// IN_PROGRESS when its driver reaches the pickup and COMPLETED at the dropoff.
+// Carpool drivers drive the engine's planned stop sequence instead: they head
+// for the first pending stop and re-read the route whenever it changes (a new
+// rider is inserted, or a stop is served).
+class CitySimulator {
+private:
+    enum class EventType : std::uint8_t { RIDE_REQUEST, PICKUP_REACHED, DROPOFF_REACHED, STOP_REACHED, GPS_ROUND };
+
+    struct Event {
+        std::int64_t timeMs;
+        std::uint64_t sequence; // FIFO among simultaneous events, for determinism
+        EventType type;
+        std::uint32_t index;    // request index, driver slot for route stops, unused for GPS rounds
+        std::uint32_t generation; // route generation a STOP_REACHED was scheduled for
+
+        bool operator>(const Event& other) const {
+            return timeMs != other.timeMs ? timeMs > other.timeMs : sequence > other.sequence;
+        }
+    };
+
+    // Straight-line leg; the driver is parked at `to` once arrivalMs has passed
+    struct SimDriver {
+        std::string driverId;
+        GeoPoint from;
+        GeoPoint to;
+        std::int64_t departureMs = 0;
+        std::int64_t arrivalMs = 0;
+        std::int64_t busyUntilMs = 0;
+        std::uint32_t routeGeneration = 0; // bumped on every carpool re-plan; older stop events are stale
+
+        GeoPoint positionAt(std::int64_t timeMs) const {
+            if (timeMs >= arrivalMs || arrivalMs <= departureMs) {
+                return to;
+            }
+            double progress = static_cast<double>(timeMs - departureMs) / (arrivalMs - departureMs);
+            return GeoPoint{from.latitudeE6 + static_cast<std::int32_t>((to.latitudeE6 - from.latitudeE6) * progress),
+                            from.longitudeE6 + static_cast<std::int32_t>((to.longitudeE6 - from.longitudeE6) * progress)};
+        }
+    };
+
+    RideManager& engine;
+    SimulationConfig config;
+    std::vector<SimDriver> simDrivers; // indexed by engine driver slot
+    std::vector<SimRideRequest> requests;
+    std::vector<std::string> rideIds;  // per request, empty until requested
+    std::vector<std::uint32_t> rideDrivers;
+    std::vector<std::int64_t> rideAssignedMs;
+    std::unordered_map<std::string, std::uint32_t> pooledRequests; // ride ID -> request index, while on a route
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::uint64_t nextSequence = 0;
+    std::shared_ptr<std::atomic<std::int64_t>> virtualNow; // shared with the engine clock
+    std::size_t riderCount = 0;
+    std::vector<TraceRecord>* trace = nullptr; // engine calls are appended here when recording
+
+    void record(TraceRecord entry) {
+        if (trace) {
+            entry.timestampMs = virtualNow->load(std::memory_order_relaxed);
+            trace->push_back(std::move(entry));
+        }
+    }
+
+    void setStatus(const std::string& rideId, RideStatus status) {
+        engine.updateRideStatus(rideId, status);
+        TraceRecord entry;
+        entry.op = TraceOp::UPDATE_RIDE_STATUS;
+        entry.subject = rideId;
+        entry.status = status;
+        record(std::move(entry));
+    }
+
+    // Falls back to wall time where per-thread CPU clocks are unavailable
+    static double threadCpuSeconds() {
+#if defined(__unix__) || defined(__APPLE__)
+        timespec now;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) {
+            return now.tv_sec + now.tv_nsec / 1e9;
+        }
+#endif
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void schedule(std::int64_t timeMs, EventType type, std::uint32_t index, std::uint32_t generation = 0) {
+        events.push(Event{timeMs, nextSequence++, type, index, generation});
+    }
+
+    std::int64_t travelMs(const GeoPoint& from, const GeoPoint& to) const {
+        double hours = GeoUtils::distanceKm(from, to) / config.speedKmh;
+        return std::max<std::int64_t>(1000, static_cast<std::int64_t>(hours * 3600000.0));
+    }
+
+    void startLeg(std::uint32_t slot, const GeoPoint& destination, std::int64_t nowMs) {
+        SimDriver& driver = simDrivers[slot];
+        driver.from = driver.positionAt(nowMs);
+        driver.to = destination;
+        driver.departureMs = nowMs;
+        driver.arrivalMs = nowMs + travelMs(driver.from, destination);
+    }
+
+    // First stop of a route that belongs to a ride this simulation requested; stops
+    // of other rides (booked on the engine from outside) are not the simulator's to serve
+    std::vector<RouteStop>::const_iterator firstOwnStop(const std::vector<RouteStop>& route) const {
+        return std::find_if(route.begin(), route.end(), [this](const RouteStop& stop) {
+            return pooledRequests.count(stop.rideId) > 0;
+        });
+    }
+
+    // Points a carpool driver at the first stop of its current route it has to serve
+    void followRoute(std::uint32_t slot, const std::vector<RouteStop>& route, std::int64_t nowMs) {
+        SimDriver& driver = simDrivers[slot];
+        driver.routeGeneration++;
+        auto stop = firstOwnStop(route);
+        if (stop != route.end()) {
+            startLeg(slot, stop->location, nowMs);
+            schedule(driver.arrivalMs, EventType::STOP_REACHED, slot, driver.routeGeneration);
+        }
+    }
+
+    void handleRequest(std::uint32_t index, std::int64_t nowMs, SimulationReport& report) {
+        const SimRideRequest& request = requests[index];
+        report.ridesRequested++;
+
+        std::string riderId = "SR" + std::to_string(index % riderCount);
+        std::string rideId;
+        try {
+            rideId = engine.requestRide(riderId, GeoUtils::toLocation(request.pickup),
+                                        GeoUtils::toLocation(request.dropoff), request.rideType,
+                                        request.vehicleType, request.passengerCount);
+        } catch (const std::exception&) {
+            report.ridesRejected++;
+            return;
+        }
+        TraceRecord entry;
+        entry.op = TraceOp::REQUEST_RIDE;
+        entry.subject = rideId;
+        entry.detail = riderId;
+        entry.point = request.pickup;
+        entry.dropoff = request.dropoff;
+        entry.rideType = request.rideType;
+        entry.vehicleType = request.vehicleType;
+        entry.count = request.passengerCount;
+        record(std::move(entry));
+
+        auto ride = engine.getRide(rideId);
+        if (!ride || !ride->getDriver()) {
+            report.ridesUnserved++;
+            setStatus(rideId, RideStatus::CANCELLED);
+            return;
+        }
+
+        std::uint32_t slot = engine.getDriverSlot(ride->getDriver()->getUserId());
+        rideIds[index] = rideId;
+        rideDrivers[index] = slot;
+        rideAssignedMs[index] = nowMs;
+        report.ridesAssigned++;
+
+        GeoPoint driverAt = simDrivers[slot].positionAt(nowMs);
+        setStatus(rideId, RideStatus::DRIVER_ENROUTE);
+        if (request.rideType == RideType::NORMAL) {
+            report.totalPickupKm += GeoUtils::distanceKm(driverAt, request.pickup);
+            startLeg(slot, request.pickup, nowMs);
+            schedule(simDrivers[slot].arrivalMs, EventType::PICKUP_REACHED, index);
+            return;
+        }
+
+        // Pooled: the pickup is reached along the planned route, after any stops before it
+        pooledRequests[rideId] = index;
+        std::vector<RouteStop> route = engine.getCarpoolRoute(simDrivers[slot].driverId);
+        GeoPoint at = driverAt;
+        for (const auto& stop : route) {
+            report.totalPickupKm += GeoUtils::distanceKm(at, stop.location);
+            at = stop.location;
+            if (stop.isPickup && stop.rideId == rideId) {
+                break;
+            }
+        }
+        followRoute(slot, route, nowMs);
+    }
+
+    void handlePickup(std::uint32_t index, std::int64_t nowMs, SimulationReport& report) {
+        report.totalWaitSeconds += (nowMs - rideAssignedMs[index]) / 1000.0;
+        setStatus(rideIds[index], RideStatus::IN_PROGRESS);
+        if (requests[index].rideType == RideType::NORMAL) {
+            std::uint32_t slot = rideDrivers[index];
+            startLeg(slot, requests[index].dropoff, nowMs);
+            schedule(simDrivers[slot].arrivalMs, EventType::DROPOFF_REACHED, index);
+        }
+    }
+
+    // A carpool driver reached the stop followRoute sent it to, unless it was re-planned since
+    void handleStop(std::uint32_t slot, std::uint32_t generation, std::int64_t nowMs, SimulationReport& report) {
+        if (generation != simDrivers[slot].routeGeneration) {
+            return;
+        }
+        std::vector<RouteStop> route = engine.getCarpoolRoute(simDrivers[slot].driverId);
+        auto stop = firstOwnStop(route);
+        if (stop == route.end()) {
+            return; // only other callers' stops left; the next own booking restarts the driver
+        }
+        auto pooled = pooledRequests.find(stop->rideId);
+        std::uint32_t index = pooled->second;
+        if (stop->isPickup) {
+            handlePickup(index, nowMs, report);
+        } else {
+            pooledRequests.erase(pooled);
+            handleDropoff(index, nowMs, report);
+        }
+        followRoute(slot, engine.getCarpoolRoute(simDrivers[slot].driverId), nowMs);
+    }
+
+    void handleDropoff(std::uint32_t index, std::int64_t nowMs, SimulationReport& report) {
+        SimDriver& driver = simDrivers[rideDrivers[index]];
+        std::int64_t busyFrom = std::max(rideAssignedMs[index], driver.busyUntilMs);
+        report.driverBusySeconds += std::max<std::int64_t>(0, nowMs - busyFrom) / 1000.0;
+        driver.busyUntilMs = std::max(driver.busyUntilMs, nowMs);
+
+        setStatus(rideIds[index], RideStatus::COMPLETED);
+        auto ride = engine.getRide(rideIds[index]);
+        if (ride) {
+            report.totalFare += ride->getFare();
+        }
+        report.ridesCompleted++;
+    }
+
+    void handleGpsRound(std::int64_t nowMs, std::int64_t endMs, SimulationReport& report,
+                        std::vector<DriverLocationUpdate>& batch) {
+        batch.clear();
+        for (std::uint32_t slot = 0; slot < simDrivers.size(); slot++) {
+            batch.push_back(DriverLocationUpdate{slot, simDrivers[slot].positionAt(nowMs), nowMs});
+        }
+        engine.ingestDriverLocations(batch);
+        if (trace) {
+            for (const auto& update : batch) {
+                TraceRecord entry;
+                entry.op = TraceOp::LOCATION_UPDATE;
+                entry.subject = simDrivers[update.driverSlot].driverId;
+                entry.point = update.position;
+                record(std::move(entry));
+            }
+        }
+        report.locationUpdates += batch.size();
+        if (nowMs + config.gpsIntervalMs <= endMs) {
+            schedule(nowMs + config.gpsIntervalMs, EventType::GPS_ROUND, 0);
+        }
+    }
+
+public:
+    CitySimulator(RideManager& engine, const SimulationConfig& config = SimulationConfig())
+        : engine(engine), config(config),
+          virtualNow(std::make_shared<std::atomic<std::int64_t>>(config.startTimeMs)) {}
+
+    // Records every engine call made from now on, for rideeasy_replay
+    void recordTo(std::vector<TraceRecord>* records) {
+        trace = records;
+    }
+
+    // Registers a driver with the engine; must happen before run()
+    void addDriver(const SimDriverSpec& spec) {
+        static const int capacities[] = {1, 4, 6, 3}; // BIKE, SEDAN, SUV, AUTO_RICKSHAW
+        int typeIndex = static_cast<int>(spec.vehicleType);
+        std::string driverId = "SD" + std::to_string(simDrivers.size());
+
+        auto driver = std::make_shared<Driver>(
+            driverId, "Sim Driver " + std::to_string(simDrivers.size()), "0",
+            Vehicle("SV" + std::to_string(simDrivers.size()), "Sim",
+                    "SIM-" + std::to_string(simDrivers.size()),
+                    VehicleTypeFactory::getVehicleTypeName(spec.vehicleType), capacities[typeIndex]),
+            GeoUtils::toLocation(spec.position));
+        engine.registerDriver(driver);
+        TraceRecord entry;
+        entry.op = TraceOp::REGISTER_DRIVER;
+        entry.subject = driverId;
+        entry.detail = driver->getName();
+        entry.point = spec.position;
+        entry.vehicleType = spec.vehicleType;
+        entry.count = capacities[typeIndex];
+        record(std::move(entry));
+
+        std::uint32_t slot = engine.getDriverSlot(driverId);
+        if (slot >= simDrivers.size()) {
+            simDrivers.resize(slot + 1);
+        }
+        simDrivers[slot].driverId = driverId;
+        simDrivers[slot].from = spec.position;
+        simDrivers[slot].to = spec.position;
+    }
+
+    void addRiders(std::size_t count) {
+        for (std::size_t i = riderCount; i < count; i++) {
+            auto rider = std::make_shared<Rider>("SR" + std::to_string(i), "Sim Rider " + std::to_string(i), "0");
+            engine.registerRider(rider);
+            TraceRecord entry;
+            entry.op = TraceOp::REGISTER_RIDER;
+            entry.subject = rider->getUserId();
+            entry.detail = rider->getName();
+            record(std::move(entry));
+        }
+        riderCount = std::max(riderCount, count);
+    }
+
+    void addRequest(const SimRideRequest& request) {
+        requests.push_back(request);
+    }
+
+    // Fleet, riders and demand from a generated workload
+    void addWorkload(const Workload& workload) {
+        for (const auto& driver : workload.drivers) {
+            addDriver(driver);
+        }
+        addRiders(workload.riderCount);
+        requests.insert(requests.end(), workload.requests.begin(), workload.requests.end());
+    }
+
+    // Runs every queued request to completion and returns the KPIs
+    SimulationReport run() {
+        if (riderCount == 0) {
+            addRiders(1);
+        }
+        SimulationReport report;
+        report.drivers = simDrivers.size();
+        auto wallStart = std::chrono::steady_clock::now();
+        double cpuStart = threadCpuSeconds();
+
+        auto now = virtualNow;
+        engine.setClock([now]() { return now->load(std::memory_order_relaxed); });
+        engine.setRandomSeed(static_cast<std::uint32_t>(config.seed));
+
+        rideIds.assign(requests.size(), std::string());
+        rideDrivers.assign(requests.size(), 0);
+        rideAssignedMs.assign(requests.size(), 0);
+        pooledRequests.clear();
+        std::int64_t lastRequestMs = config.startTimeMs;
+        for (std::uint32_t i = 0; i < requests.size(); i++) {
+            schedule(config.startTimeMs + requests[i].offsetMs, EventType::RIDE_REQUEST, i);
+            lastRequestMs = std::max(lastRequestMs, config.startTimeMs + requests[i].offsetMs);
+        }
+        if (config.gpsIntervalMs > 0 && !simDrivers.empty()) {
+            schedule(config.startTimeMs, EventType::GPS_ROUND, 0);
+        }
+
+        std::vector<DriverLocationUpdate> batch;
+        std::int64_t nowMs = config.startTimeMs;
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            nowMs = event.timeMs;
+            virtualNow->store(nowMs, std::memory_order_relaxed);
+            report.events++;
+
+            switch (event.type) {
+                case EventType::RIDE_REQUEST: handleRequest(event.index, nowMs, report); break;
+                case EventType::PICKUP_REACHED: handlePickup(event.index, nowMs, report); break;
+                case EventType::DROPOFF_REACHED: handleDropoff(event.index, nowMs, report); break;
+                case EventType::STOP_REACHED: handleStop(event.index, event.generation, nowMs, report); break;
+                case EventType::GPS_ROUND: handleGpsRound(nowMs, lastRequestMs, report, batch); break;
+            }
+        }
+
+        report.simulatedSeconds = (nowMs - config.startTimeMs) / 1000.0;
+        report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        report.cpuSeconds = threadCpuSeconds() - cpuStart;
+        return report;
+    }
+
+    // Uniform demand and fleet over a bounding box, for quick runs without a workload file
+    static void populateUniform(CitySimulator& simulator, std::size_t drivers, std::size_t rides,
+                                double durationHours, std::uint64_t seed,
+                                double minLatitude = 18.90, double maxLatitude = 19.25,
+                                double minLongitude = 72.80, double maxLongitude = 73.00) {
+        std::mt19937_64 gen(seed);
+        std::uniform_real_distribution<> latitude(minLatitude, maxLatitude);
+        std::uniform_real_distribution<> longitude(minLongitude, maxLongitude);
+        std::uniform_int_distribution<int> vehicleType(0, 3);
+        std::uniform_real_distribution<> unit(0.0, 1.0);
+        std::exponential_distribution<> gap(rides / (durationHours * 3600000.0));
+
+        for (std::size_t i = 0; i < drivers; i++) {
+            simulator.addDriver({GeoPoint::fromDegrees(latitude(gen), longitude(gen)),
+                                 static_cast<VehicleType>(vehicleType(gen))});
+        }
+        simulator.addRiders(std::max<std::size_t>(1, rides / 10));
+
+        double offsetMs = 0.0;
+        for (std::size_t i = 0; i < rides; i++) {
+            offsetMs += gap(gen);
+            GeoPoint pickup = GeoPoint::fromDegrees(latitude(gen), longitude(gen));
+            GeoPoint dropoff = GeoPoint::fromDegrees(latitude(gen), longitude(gen));
+            simulator.addRequest({static_cast<std::int64_t>(offsetMs), pickup, dropoff,
+                                  unit(gen) < 0.1 ? RideType::CARPOOL : RideType::NORMAL,
+                                  static_cast<VehicleType>(vehicleType(gen)), 1});
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <iostream>
+#include <cstring>
+
+// Common front end of the tools' "--option value" command lines, run before a
+// tool's own option loop: --help (or -h) prints the usage, and an option left
+// without a value is reported with it. Returns the exit code to stop with, or
+// -1 when the tool should go on and parse its options.
+inline int checkCommandLine(int argc, char* argv[], const char* usage) {
+    for (int i = 1; i < argc; i += 2) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            std::cout << usage;
+            return 0;
+        }
+        if (i + 1 == argc) {
+            std::cerr << "Missing value for " << argv[i] << std::endl << usage;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef FLIGHT_DUMP_H
+#define FLIGHT_DUMP_H
+
+#include "BinaryIO.h"
+#include "FlightRecorder.h"
+#include "RideTypes.h"
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+// A FlightRecorder dump read back for inspection. Dumps are written in host
+// byte order; this reads little-endian, which covers the platforms we ship on.
+struct FlightDump {
+    struct Thread {
+        std::uint32_t threadIndex = 0;
+        std::uint64_t firstSequence = 0; // sequence number of records.front() on its thread
+        std::vector<FlightRecord> records;
+    };
+
+    // One record placed on the dump's timeline
+    struct Entry {
+        double msBeforeDump; // how long before the dump it was recorded
+        std::uint32_t threadIndex;
+        std::uint64_t sequence;
+        FlightRecord record;
+    };
+
+    FlightDumpReason reason = FlightDumpReason::ON_DEMAND;
+    std::int32_t code = 0; // signal number or FlightAnomaly
+    double nsPerTick = 1.0;
+    std::uint64_t dumpTicks = 0;
+    std::uint64_t droppedThreads = 0; // threads that found no free ring (not in version 1 dumps)
+    std::vector<Thread> threads;
+
+    static FlightDump load(const std::string& path) {
+        std::vector<std::uint8_t> bytes = ByteReader::loadFile(path);
+        bool version1 = bytes.size() >= 8 && std::memcmp(bytes.data(), "RIDEFLT1", 8) == 0;
+        if (!version1 && (bytes.size() < 8 || std::memcmp(bytes.data(), "RIDEFLT2", 8) != 0)) {
+            throw std::runtime_error("Not a flight recording: " + path);
+        }
+        ByteReader reader(bytes, "Flight recording " + path, 8);
+        FlightDump dump;
+        dump.reason = static_cast<FlightDumpReason>(reader.fixed(4));
+        dump.code = static_cast<std::int32_t>(reader.fixed(4));
+        std::uint64_t startTicks = reader.fixed(8);
+        std::int64_t startNs = static_cast<std::int64_t>(reader.fixed(8));
+        dump.dumpTicks = reader.fixed(8);
+        std::int64_t dumpNs = static_cast<std::int64_t>(reader.fixed(8));
+        if (!version1) {
+            dump.droppedThreads = reader.fixed(8);
+        }
+        if (dump.dumpTicks > startTicks && dumpNs > startNs) {
+            dump.nsPerTick = static_cast<double>(dumpNs - startNs) / static_cast<double>(dump.dumpTicks - startTicks);
+        }
+        std::uint64_t threadCount = reader.fixed(4);
+        for (std::uint64_t t = 0; t < threadCount; t++) {
+            Thread thread;
+            thread.threadIndex = static_cast<std::uint32_t>(reader.fixed(4));
+            std::uint64_t count = reader.fixed(4);
+            thread.firstSequence = reader.fixed(8);
+            reader.need(count * sizeof(FlightRecord));
+            thread.records.resize(count);
+            for (FlightRecord& record : thread.records) {
+                record.ticks = reader.fixed(8);
+                record.event = static_cast<std::uint16_t>(reader.fixed(2));
+                record.code = static_cast<std::uint16_t>(reader.fixed(2));
+                record.subject = static_cast<std::uint32_t>(reader.fixed(4));
+                record.detail = static_cast<std::uint32_t>(reader.fixed(4));
+                record.reserved = static_cast<std::uint32_t>(reader.fixed(4));
+                record.value = static_cast<std::int64_t>(reader.fixed(8));
+            }
+            dump.threads.push_back(std::move(thread));
+        }
+        return dump;
+    }
+
+    // Every thread's records merged, oldest first
+    std::vector<Entry> timeline() const {
+        std::vector<Entry> entries;
+        for (const Thread& thread : threads) {
+            for (std::size_t i = 0; i < thread.records.size(); i++) {
+                const FlightRecord& record = thread.records[i];
+                double ticksBefore = static_cast<double>(dumpTicks) - static_cast<double>(record.ticks);
+                entries.push_back({ticksBefore * nsPerTick / 1e6, thread.threadIndex, thread.firstSequence + i, record});
+            }
+        }
+        std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.record.ticks < b.record.ticks;
+        });
+        return entries;
+    }
+
+    static const char* eventName(std::uint16_t event) {
+        static const char* const names[] = {"registerRider", "registerDriver", "requestRide", "requestDone",
+                                            "rideStatus",    "driverStatus",   "driverAssigned", "driverRejected",
+                                            "noDriver",      "completeRide",   "locationUpdate", "locationBatch",
+                                            "ANOMALY"};
+        static_assert(sizeof(names) / sizeof(names[0]) == static_cast<std::size_t>(FlightEvent::COUNT),
+                      "every flight event needs a name");
+        return event < static_cast<std::uint16_t>(FlightEvent::COUNT) ? names[event] : "unknown";
+    }
+
+    static const char* anomalyName(std::int32_t anomaly) {
+        return anomaly == static_cast<std::int32_t>(FlightAnomaly::SLOW_REQUEST) ? "slow request" : "manual";
+    }
+
+    static const char* rideStatusName(std::uint32_t status) {
+        static const char* const names[] = {"REQUESTED", "DRIVER_ASSIGNED", "DRIVER_ENROUTE",
+                                            "IN_PROGRESS", "COMPLETED", "CANCELLED"};
+        return status < 6 ? names[status] : "?";
+    }
+
+    static const char* driverStatusName(std::uint32_t status) {
+        static const char* const names[] = {"AVAILABLE", "ON_TRIP", "OFFLINE"};
+        return status < 3 ? names[status] : "?";
+    }
+
+    // Event fields spelled out (see FlightEvent for what each one records)
+    static std::string describe(const FlightRecord& record) {
+        std::ostringstream text;
+        switch (static_cast<FlightEvent>(record.event)) {
+            case FlightEvent::REGISTER_RIDER:
+                text << "riders=" << record.subject;
+                break;
+            case FlightEvent::REGISTER_DRIVER:
+                text << "driver=" << record.subject;
+                break;
+            case FlightEvent::REQUEST_RIDE:
+                text << "ride=" << record.subject << " type=" << (record.code == 0 ? "normal" : "carpool")
+                     << " vehicle=" << VehicleTypeFactory::getVehicleTypeName(static_cast<VehicleType>(record.detail));
+                break;
+            case FlightEvent::REQUEST_DONE:
+                text << "ride=" << record.subject << " took=" << record.value / 1000.0 << "us";
+                break;
+            case FlightEvent::RIDE_STATUS:
+                text << "ride=" << record.subject << ' ' << rideStatusName(record.detail) << " -> "
+                     << rideStatusName(record.code);
+                break;
+            case FlightEvent::DRIVER_STATUS:
+                text << "driver=" << record.subject << ' ' << driverStatusName(record.detail) << " -> "
+                     << driverStatusName(record.code);
+                break;
+            case FlightEvent::DRIVER_ASSIGNED:
+                text << "ride=" << record.subject << " driver=" << record.detail << " offers=" << record.code;
+                break;
+            case FlightEvent::DRIVER_REJECTED:
+                text << "ride=" << record.subject << " driver=" << record.detail;
+                break;
+            case FlightEvent::NO_DRIVER:
+                text << "ride=" << record.subject << " candidates=" << record.detail << " offers=" << record.code;
+                break;
+            case FlightEvent::COMPLETE_RIDE:
+                text << "ride=" << record.subject << " fare=" << record.value / 100.0;
+                break;
+            case FlightEvent::LOCATION_UPDATE:
+                text << "driver=" << record.subject << " lat=" << static_cast<std::int32_t>(record.detail) / 1e6
+                     << " lng=" << record.value / 1e6;
+                break;
+            case FlightEvent::LOCATION_BATCH:
+                text << "updates=" << record.detail;
+                break;
+            case FlightEvent::ANOMALY:
+                text << anomalyName(record.code) << " subject=" << record.subject << " value=" << record.value;
+                break;
+            default:
+                text << "code=" << record.code << " subject=" << record.subject << " detail=" << record.detail
+                     << " value=" << record.value;
+                break;
+        }
+        return text.str();
+    }
+};
+
+#endif
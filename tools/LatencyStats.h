@@ -0,0 +1,32 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// Latencies of one kind of call, in nanoseconds
+struct OperationStats {
+    std::vector<std::int64_t> latenciesNs;
+    std::size_t errors = 0;
+
+    void merge(const OperationStats& other) {
+        latenciesNs.insert(latenciesNs.end(), other.latenciesNs.begin(), other.latenciesNs.end());
+        errors += other.errors;
+    }
+
+    // Nearest-rank percentile (0..100); sorts on first use after recording
+    std::int64_t percentile(double p) {
+        if (latenciesNs.empty()) {
+            return 0;
+        }
+        if (!std::is_sorted(latenciesNs.begin(), latenciesNs.end())) {
+            std::sort(latenciesNs.begin(), latenciesNs.end());
+        }
+        std::size_t rank = static_cast<std::size_t>(p / 100.0 * latenciesNs.size());
+        return latenciesNs[std::min(rank, latenciesNs.size() - 1)];
+    }
+};
+
+#endif
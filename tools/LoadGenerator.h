@@ -0,0 +1,208 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include "RideManager.h"
+#include "GeoUtils.h"
+#include "LatencyStats.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+struct LoadConfig {
+    double ratePerSecond = 10000.0; // target total rate across all threads
+    double durationSeconds = 5.0;
+    unsigned threads = 4;
+    double locationShare = 0.8;     // fraction of operations that are location updates
+    double lateThresholdMs = 1.0;   // a call starting later than this after its send time counts as late
+    std::uint64_t seed = 42;
+};
+
+enum class LoadOperation { LOCATION_UPDATE, RIDE };
+
+struct LoadResult {
+    // Per LoadOperation. corrected: from the intended send time (what a client
+    // waiting on the schedule sees); service: from the actual call start.
+    OperationStats corrected[2];
+    OperationStats service[2];
+    std::size_t issued = 0;
+    std::size_t late = 0;       // started more than lateThresholdMs after the intended send time
+    double wallSeconds = 0.0;
+    double achievedRate = 0.0;  // operations completed inside the scheduled window, per second of it
+    double maxBehindMs = 0.0;   // largest gap between intended and actual send time
+};
+
+// Open-loop load against RideManager: each thread owns an evenly spaced
+// schedule of intended send times (rate / threads per thread, phase-shifted
+// so threads interleave). Calls are synchronous, so a slow call delays the
+// thread's next sends; those then go out back to back until the thread
+// catches up, and nothing is skipped. Latency is measured from the intended
+// send time, so time spent queued behind a stalled call is counted instead of
+// silently skipped (coordinated omission). A saturated engine shows up as
+// late starts and as fewer operations completing inside the scheduled window.
+// A ride operation is requestRide followed by COMPLETED (assigned) or
+// CANCELLED (unserved), which keeps the fleet free.
+class LoadGenerator {
+private:
+    RideManager& engine;
+    std::vector<std::string> driverIds;
+    std::vector<std::string> riderIds;
+    double minLatitude = 18.90, maxLatitude = 19.25;
+    double minLongitude = 72.80, maxLongitude = 73.00;
+
+    struct ThreadResult {
+        OperationStats corrected[2];
+        OperationStats service[2];
+        std::size_t issued = 0;
+        std::size_t completedInWindow = 0;
+        std::size_t late = 0;
+        std::int64_t maxBehindNs = 0;
+    };
+
+    void runThread(const LoadConfig& config, unsigned threadIndex, std::chrono::steady_clock::time_point start,
+                   ThreadResult& result) {
+        std::mt19937_64 gen(config.seed * 1000003 + threadIndex);
+        std::uniform_real_distribution<> unit(0.0, 1.0);
+        std::uniform_real_distribution<> latitude(minLatitude, maxLatitude);
+        std::uniform_real_distribution<> longitude(minLongitude, maxLongitude);
+        std::uniform_int_distribution<std::size_t> pickDriver(0, driverIds.size() - 1);
+        std::uniform_int_distribution<std::size_t> pickRider(0, riderIds.size() - 1);
+        std::uniform_int_distribution<int> pickVehicle(0, 3);
+
+        double intervalNs = 1e9 * config.threads / config.ratePerSecond;
+        auto end = start + std::chrono::nanoseconds(static_cast<std::int64_t>(config.durationSeconds * 1e9));
+        std::size_t expected = static_cast<std::size_t>(config.durationSeconds * config.ratePerSecond / config.threads);
+        for (int op = 0; op < 2; op++) {
+            result.corrected[op].latenciesNs.reserve(expected / 2 + 16);
+            result.service[op].latenciesNs.reserve(expected / 2 + 16);
+        }
+
+        for (std::uint64_t k = 0;; k++) {
+            auto intended = start + std::chrono::nanoseconds(
+                static_cast<std::int64_t>((k + static_cast<double>(threadIndex) / config.threads) * intervalNs));
+            if (intended >= end) {
+                break;
+            }
+            // Sleep most of the way, then spin, so wake-up jitter does not pose as latency
+            auto now = std::chrono::steady_clock::now();
+            if (intended - now > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_until(intended - std::chrono::microseconds(100));
+            }
+            while ((now = std::chrono::steady_clock::now()) < intended) {
+                std::this_thread::yield(); // lets other load threads run when cores are oversubscribed
+            }
+            std::int64_t behindNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now - intended).count();
+            result.maxBehindNs = std::max(result.maxBehindNs, behindNs);
+            if (behindNs > config.lateThresholdMs * 1e6) {
+                result.late++;
+            }
+
+            LoadOperation kind = unit(gen) < config.locationShare ? LoadOperation::LOCATION_UPDATE : LoadOperation::RIDE;
+            int op = static_cast<int>(kind);
+            bool failed = false;
+            try {
+                if (kind == LoadOperation::LOCATION_UPDATE) {
+                    engine.updateDriverLocation(driverIds[pickDriver(gen)], latitude(gen), longitude(gen));
+                } else {
+                    Location pickup(latitude(gen), longitude(gen));
+                    Location dropoff(latitude(gen), longitude(gen));
+                    std::string rideId = engine.requestRide(riderIds[pickRider(gen)], pickup, dropoff,
+                                                            RideType::NORMAL,
+                                                            static_cast<VehicleType>(pickVehicle(gen)), 1);
+                    auto ride = engine.getRide(rideId);
+                    engine.updateRideStatus(rideId, ride && ride->getDriver() ? RideStatus::COMPLETED
+                                                                              : RideStatus::CANCELLED);
+                }
+            } catch (const std::exception&) {
+                failed = true;
+            }
+            auto done = std::chrono::steady_clock::now();
+            result.corrected[op].latenciesNs.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count());
+            result.service[op].latenciesNs.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(done - now).count());
+            if (failed) {
+                result.corrected[op].errors++;
+                result.service[op].errors++;
+            }
+            result.issued++;
+            if (done <= end) {
+                result.completedInWindow++;
+            }
+        }
+    }
+
+public:
+    explicit LoadGenerator(RideManager& engine) : engine(engine) {}
+
+    // Registers a fleet and riders spread uniformly over the city
+    void setupFleet(std::size_t drivers, std::size_t riders, std::uint64_t seed) {
+        static const int capacities[] = {1, 4, 6, 3}; // BIKE, SEDAN, SUV, AUTO_RICKSHAW
+        std::mt19937_64 gen(seed);
+        std::uniform_real_distribution<> latitude(minLatitude, maxLatitude);
+        std::uniform_real_distribution<> longitude(minLongitude, maxLongitude);
+        std::uniform_int_distribution<int> pickVehicle(0, 3);
+
+        for (std::size_t i = driverIds.size(); i < drivers; i++) {
+            std::string id = "LD" + std::to_string(i);
+            int type = pickVehicle(gen);
+            engine.registerDriver(std::make_shared<Driver>(
+                id, "Load Driver " + std::to_string(i), "0",
+                Vehicle("LV" + std::to_string(i), "Load", "LOAD-" + std::to_string(i),
+                        VehicleTypeFactory::getVehicleTypeName(static_cast<VehicleType>(type)), capacities[type]),
+                Location(latitude(gen), longitude(gen))));
+            driverIds.push_back(id);
+        }
+        for (std::size_t i = riderIds.size(); i < riders; i++) {
+            std::string id = "LR" + std::to_string(i);
+            engine.registerRider(std::make_shared<Rider>(id, "Load Rider " + std::to_string(i), "0"));
+            riderIds.push_back(id);
+        }
+    }
+
+    LoadResult run(const LoadConfig& config) {
+        if (driverIds.empty() || riderIds.empty()) {
+            throw std::logic_error("setupFleet must register drivers and riders before run");
+        }
+        if (config.threads == 0 || config.ratePerSecond <= 0.0 || config.durationSeconds <= 0.0) {
+            throw std::invalid_argument("Load needs at least one thread, a positive rate and a positive duration");
+        }
+
+        std::vector<ThreadResult> perThread(config.threads);
+        std::vector<std::thread> workers;
+        // A short lead time so every thread is parked before the first send
+        auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+        for (unsigned t = 0; t < config.threads; t++) {
+            workers.emplace_back([this, &config, t, start, &perThread]() { runThread(config, t, start, perThread[t]); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        LoadResult result;
+        std::size_t completedInWindow = 0;
+        result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto& thread : perThread) {
+            for (int op = 0; op < 2; op++) {
+                result.corrected[op].merge(thread.corrected[op]);
+                result.service[op].merge(thread.service[op]);
+            }
+            result.issued += thread.issued;
+            result.late += thread.late;
+            completedInWindow += thread.completedInWindow;
+            result.maxBehindMs = std::max(result.maxBehindMs, thread.maxBehindNs / 1e6);
+        }
+        // Every scheduled call is eventually issued, so issued / wall time tracks the
+        // target even when the engine falls behind; only the window shows saturation
+        result.achievedRate = completedInWindow / config.durationSeconds;
+        return result;
+    }
+};
+
+#endif
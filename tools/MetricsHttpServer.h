@@ -0,0 +1,148 @@
+#ifndef METRICS_HTTP_SERVER_H
+#define METRICS_HTTP_SERVER_H
+
+#include "MetricsRegistry.h"
+#include <string>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Serves a registry's text exposition to Prometheus on 127.0.0.1:<port>.
+// Any GET is answered with the current metrics; one request at a time, on a
+// background thread. A client that sends nothing (or stops reading) is dropped
+// after CLIENT_TIMEOUT_MS, so it cannot hold up other scrapes or shutdown.
+// POSIX only: elsewhere the constructor throws, and tools fall back to writing
+// a file.
+class MetricsHttpServer {
+private:
+    static constexpr int CLIENT_TIMEOUT_MS = 2000;
+    static constexpr int POLL_INTERVAL_MS = 100;
+
+    const MetricsRegistry& registry;
+    int listener = -1;
+    std::uint16_t port = 0;
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+#if defined(__unix__) || defined(__APPLE__)
+    // Waits for the client's request in short polls, re-checking running
+    bool awaitRequest(int client) {
+        for (int waitedMs = 0; waitedMs < CLIENT_TIMEOUT_MS && running.load(); waitedMs += POLL_INTERVAL_MS) {
+            pollfd waiting{client, POLLIN, 0};
+            int ready = poll(&waiting, 1, POLL_INTERVAL_MS);
+            if (ready < 0 && errno != EINTR) {
+                return false;
+            }
+            if (ready > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void serve(int client) {
+        if (!awaitRequest(client)) {
+            return;
+        }
+        timeval sendTimeout{CLIENT_TIMEOUT_MS / 1000, (CLIENT_TIMEOUT_MS % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+        char request[1024];
+        ssize_t received = recv(client, request, sizeof(request) - 1, 0);
+        if (received <= 0) {
+            return;
+        }
+        request[received] = '\0';
+        bool isGet = std::strncmp(request, "GET ", 4) == 0;
+        std::string body = isGet ? registry.render() : "Only GET is supported\n";
+        std::string response = std::string(isGet ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 405 Method Not Allowed\r\n") +
+                               "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                               "Connection: close\r\n\r\n" + body;
+        std::size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t written = send(client, response.data() + sent, response.size() - sent, 0);
+            if (written <= 0) {
+                return;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+    }
+
+    void acceptLoop() {
+        while (running.load()) {
+            pollfd waiting{listener, POLLIN, 0};
+            if (poll(&waiting, 1, 100) <= 0) {
+                continue; // timeout: re-check running
+            }
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            serve(client);
+            close(client);
+        }
+    }
+#endif
+
+public:
+    // Port 0 picks a free port; see getPort()
+    MetricsHttpServer(const MetricsRegistry& registry, std::uint16_t requestedPort) : registry(registry) {
+#if defined(__unix__) || defined(__APPLE__)
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener < 0) {
+            throw std::runtime_error(std::string("Cannot create metrics socket: ") + std::strerror(errno));
+        }
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(requestedPort);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0) {
+            std::string error = std::strerror(errno);
+            close(listener);
+            throw std::runtime_error("Cannot listen on 127.0.0.1:" + std::to_string(requestedPort) + ": " + error);
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+        port = ntohs(address.sin_port);
+        running = true;
+        worker = std::thread(&MetricsHttpServer::acceptLoop, this);
+#else
+        (void)requestedPort;
+        throw std::runtime_error("The metrics HTTP endpoint needs POSIX sockets");
+#endif
+    }
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    ~MetricsHttpServer() {
+        running = false;
+        if (worker.joinable()) {
+            worker.join();
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        if (listener >= 0) {
+            close(listener);
+        }
+#endif
+    }
+
+    std::uint16_t getPort() const { return port; }
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum class PerfEvent { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES };
+constexpr std::size_t PERF_EVENT_COUNT = 4;
+
+struct PerfSample {
+    std::uint64_t values[PERF_EVENT_COUNT] = {};
+    bool present[PERF_EVENT_COUNT] = {}; // events the CPU or kernel could not count stay absent
+
+    std::uint64_t operator[](PerfEvent event) const { return values[static_cast<std::size_t>(event)]; }
+    bool has(PerfEvent event) const { return present[static_cast<std::size_t>(event)]; }
+};
+
+// Hardware counters of the calling thread (user space only) via Linux
+// perf_event, opened as one group so all of them cover the same interval.
+// Anywhere else, or when the kernel refuses (perf_event_paranoid, containers,
+// VMs without a PMU), available() is false, getError() says why and read()
+// returns an empty sample. Values are scaled up when the kernel multiplexes
+// the group with other counters.
+class PerfCounters {
+private:
+    int descriptors[PERF_EVENT_COUNT] = {-1, -1, -1, -1};
+    std::uint64_t ids[PERF_EVENT_COUNT] = {}; // kernel IDs matching group read entries to events
+    std::string error;
+
+public:
+    PerfCounters() {
+#if defined(__linux__)
+        static const std::uint64_t configs[PERF_EVENT_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES};
+        for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.disabled = descriptors[0] < 0 ? 1 : 0; // the leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING |
+                               PERF_FORMAT_ID;
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, descriptors[0], 0));
+            if (fd < 0 && i == 0) {
+                error = std::string("perf_event_open: ") + std::strerror(errno);
+                return;
+            }
+            descriptors[i] = fd; // a missing member leaves that event absent
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_ID, &ids[i]);
+            }
+        }
+        ioctl(descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        error = "hardware counters need Linux perf_event";
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : descriptors) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    bool available() const { return descriptors[0] >= 0; }
+    const std::string& getError() const { return error; }
+
+    // Counts since the group was opened
+    PerfSample read() const {
+        PerfSample sample;
+#if defined(__linux__)
+        if (!available()) {
+            return sample;
+        }
+        // nr, time_enabled, time_running, then {value, id} per open event
+        std::uint64_t buffer[3 + 2 * PERF_EVENT_COUNT];
+        if (::read(descriptors[0], buffer, sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t))) {
+            return sample;
+        }
+        double scale = buffer[2] > 0 ? static_cast<double>(buffer[1]) / buffer[2] : 0.0;
+        for (std::uint64_t k = 0; k < buffer[0] && k < PERF_EVENT_COUNT; k++) {
+            std::uint64_t value = buffer[3 + 2 * k];
+            std::uint64_t id = buffer[4 + 2 * k];
+            for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+                if (descriptors[i] >= 0 && ids[i] == id) {
+                    sample.values[i] = static_cast<std::uint64_t>(value * scale);
+                    sample.present[i] = true;
+                }
+            }
+        }
+#endif
+        return sample;
+    }
+};
+
+inline PerfSample operator-(const PerfSample& later, const PerfSample& earlier) {
+    PerfSample delta;
+    for (std::size_t i = 0; i < PERF_EVENT_COUNT; i++) {
+        delta.present[i] = later.present[i] && earlier.present[i];
+        delta.values[i] = delta.present[i] ? later.values[i] - earlier.values[i] : 0;
+    }
+    return delta;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef PRICING_FUZZ_H
+#define PRICING_FUZZ_H
+
+#include "CompiledPricing.h"
+#include <random>
+#include <vector>
+#include <cstdint>
+
+// Random decorator stacks and pricing inputs shared by the pricing benchmark
+// and the differential checker
+class PricingFuzz {
+private:
+    std::mt19937_64 gen;
+
+public:
+    explicit PricingFuzz(std::uint64_t seed) : gen(seed) {}
+
+    // Up to maxDepth steps, all within the decorators' validation limits
+    PricingPlan randomPlan(int maxDepth) {
+        PricingPlan plan;
+        std::uniform_int_distribution<int> depthDis(0, maxDepth);
+        std::uniform_int_distribution<int> kindDis(0, 2);
+        std::uniform_real_distribution<> surgeDis(0.5, 5.0);
+        std::uniform_real_distribution<> discountDis(0.0, 100.0);
+        std::uniform_real_distribution<> tollDis(0.0, 250.0);
+
+        int depth = depthDis(gen);
+        for (int i = 0; i < depth; i++) {
+            switch (kindDis(gen)) {
+                case 0: plan.surge(surgeDis(gen)); break;
+                case 1: plan.discount(discountDis(gen)); break;
+                default: plan.toll(tollDis(gen)); break;
+            }
+        }
+        return plan;
+    }
+
+    // Includes one value past the enum, which pricing maps to the factory defaults
+    VehicleType randomVehicleType() {
+        std::uniform_int_distribution<int> dis(0, 4);
+        return static_cast<VehicleType>(dis(gen));
+    }
+
+    // Mostly realistic trip lengths plus the edge cases that exercise the
+    // minimum-fare clamps and the negative distance check
+    double randomDistance() {
+        std::uniform_int_distribution<int> caseDis(0, 99);
+        int pick = caseDis(gen);
+        if (pick == 0) return 0.0;
+        if (pick == 1) return -std::uniform_real_distribution<>(0.0, 50.0)(gen);
+        if (pick < 5) return std::uniform_real_distribution<>(0.0, 0.01)(gen);
+        if (pick < 8) return std::uniform_real_distribution<>(100.0, 5000.0)(gen);
+        return std::uniform_real_distribution<>(0.0, 60.0)(gen);
+    }
+
+    // Non-negative distances only, for throughput measurements
+    void fillInputs(std::vector<double>& distances, std::vector<VehicleType>& vehicleTypes) {
+        std::uniform_real_distribution<> distanceDis(0.0, 60.0);
+        for (std::size_t i = 0; i < distances.size(); i++) {
+            distances[i] = distanceDis(gen);
+            vehicleTypes[i] = randomVehicleType();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,419 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "User.h"
+#include "RideTypes.h"
+#include "BinaryIO.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+enum class TraceOp : std::uint8_t {
+    REGISTER_RIDER,
+    REGISTER_DRIVER,
+    LOCATION_UPDATE,
+    REQUEST_RIDE,
+    UPDATE_RIDE_STATUS
+};
+
+// One recorded RideManager call. Rides are referred to by the ID the engine
+// returned when the trace was recorded; replay maps them to the new IDs.
+struct TraceRecord {
+    std::int64_t timestampMs = 0;
+    TraceOp op = TraceOp::REGISTER_RIDER;
+    std::string subject; // rider, driver or recorded ride ID
+    std::string detail;  // rider/driver name, or the rider ID of a ride request
+    GeoPoint point;      // driver position, location fix or pickup
+    GeoPoint dropoff;
+    VehicleType vehicleType = VehicleType::SEDAN;
+    RideType rideType = RideType::NORMAL;
+    int count = 1;       // vehicle capacity or passenger count
+    RideStatus status = RideStatus::REQUESTED;
+};
+
+// Reads and writes traces as CSV (for hand-written and exported traces) or as a
+// compact binary file; load() tells them apart by the binary magic.
+//
+// CSV lines, '#' for comments:
+//     <ms>,rider,<riderId>,<name>
+//     <ms>,driver,<driverId>,<name>,<vehicleType>,<capacity>,<lat>,<lng>
+//     <ms>,location,<driverId>,<lat>,<lng>
+//     <ms>,request,<rideId>,<riderId>,<pickupLat>,<pickupLng>,<dropoffLat>,<dropoffLng>,
+//         <NORMAL|CARPOOL>,<vehicleType>,<passengers>
+//     <ms>,status,<rideId>,<status>
+// Vehicle types and statuses use the enum names (SEDAN, DRIVER_ENROUTE, ...).
+// IDs and names containing a comma, quote or line break are written in double
+// quotes with inner quotes doubled (RFC 4180), and read back the same way.
+//
+// Binary: "RIDETRC1", a string table (count, then length-prefixed strings)
+// and the records; timestamps are zigzag varint deltas and IDs are varint
+// indexes into the string table.
+class TraceFile {
+private:
+    static constexpr char MAGIC[8] = {'R', 'I', 'D', 'E', 'T', 'R', 'C', '1'};
+
+    static const char* const* vehicleTypeNames() {
+        static const char* const names[] = {"BIKE", "SEDAN", "SUV", "AUTO_RICKSHAW"};
+        return names;
+    }
+
+    static const char* const* statusNames() {
+        static const char* const names[] = {"REQUESTED", "DRIVER_ASSIGNED", "DRIVER_ENROUTE",
+                                            "IN_PROGRESS", "COMPLETED", "CANCELLED"};
+        return names;
+    }
+
+    static const char* const* opNames() {
+        static const char* const names[] = {"rider", "driver", "location", "request", "status"};
+        return names;
+    }
+
+    template <typename Enum>
+    static Enum parseName(const std::string& value, const char* const* names, int count, int lineNumber) {
+        for (int i = 0; i < count; i++) {
+            if (value == names[i]) {
+                return static_cast<Enum>(i);
+            }
+        }
+        throw std::runtime_error("Trace line " + std::to_string(lineNumber) + ": unknown value " + value);
+    }
+
+    static GeoPoint parsePoint(const std::string& latitude, const std::string& longitude, int lineNumber) {
+        try {
+            return GeoPoint::fromDegrees(std::stod(latitude), std::stod(longitude));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Trace line " + std::to_string(lineNumber) + ": bad coordinate");
+        }
+    }
+
+    static void writeText(std::ostream& output, const std::string& value) {
+        output << ',';
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            output << value;
+            return;
+        }
+        output << '"';
+        for (char c : value) {
+            if (c == '"') {
+                output << '"';
+            }
+            output << c;
+        }
+        output << '"';
+    }
+
+    // Splits one CSV record, keeping empty fields (a trailing comma ends with an
+    // empty field). Returns false if a quoted field is still open at the end.
+    static bool splitFields(const std::string& text, std::vector<std::string>& fields) {
+        fields.assign(1, std::string());
+        bool quoted = false;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            char c = text[i];
+            if (quoted) {
+                if (c != '"') {
+                    fields.back() += c;
+                } else if (i + 1 < text.size() && text[i + 1] == '"') {
+                    fields.back() += '"';
+                    i++;
+                } else {
+                    quoted = false;
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == ',') {
+                fields.emplace_back();
+            } else {
+                fields.back() += c;
+            }
+        }
+        return !quoted;
+    }
+
+    static void writePoint(std::ostream& output, const GeoPoint& point) {
+        output << ',' << point.latitude() << ',' << point.longitude();
+    }
+
+    static void writeFixedPoint(ByteWriter& out, const GeoPoint& point) {
+        out.fixed(static_cast<std::uint32_t>(point.latitudeE6), 4);
+        out.fixed(static_cast<std::uint32_t>(point.longitudeE6), 4);
+    }
+
+    static GeoPoint readFixedPoint(ByteReader& in) {
+        GeoPoint point;
+        point.latitudeE6 = static_cast<std::int32_t>(in.fixed(4));
+        point.longitudeE6 = static_cast<std::int32_t>(in.fixed(4));
+        return point;
+    }
+
+public:
+    static std::vector<TraceRecord> readCsv(std::istream& input) {
+        std::vector<TraceRecord> records;
+        std::vector<std::string> fields;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(input, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            // A quoted field may carry line breaks; keep reading until it closes
+            std::string text = line;
+            while (!splitFields(text, fields)) {
+                if (!std::getline(input, line)) {
+                    throw std::runtime_error("Trace line " + std::to_string(lineNumber) + ": unterminated quote");
+                }
+                lineNumber++;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                text += '\n';
+                text += line;
+            }
+            static const std::size_t fieldCounts[] = {4, 8, 5, 11, 4};
+            if (fields.size() < 2) {
+                throw std::runtime_error("Trace line " + std::to_string(lineNumber) + ": too few fields");
+            }
+
+            TraceRecord record;
+            record.op = parseName<TraceOp>(fields[1], opNames(), 5, lineNumber);
+            if (fields.size() != fieldCounts[static_cast<int>(record.op)]) {
+                throw std::runtime_error("Trace line " + std::to_string(lineNumber) + ": expected " +
+                                         std::to_string(fieldCounts[static_cast<int>(record.op)]) + " fields");
+            }
+            try {
+                record.timestampMs = std::stoll(fields[0]);
+            } catch (const std::logic_error&) {
+                throw std::runtime_error("Trace line " + std::to_string(lineNumber) + ": bad timestamp");
+            }
+            record.subject = fields[2];
+
+            switch (record.op) {
+                case TraceOp::REGISTER_RIDER:
+                    record.detail = fields[3];
+                    break;
+                case TraceOp::REGISTER_DRIVER:
+                    record.detail = fields[3];
+                    record.vehicleType = parseName<VehicleType>(fields[4], vehicleTypeNames(), 4, lineNumber);
+                    record.count = std::atoi(fields[5].c_str());
+                    record.point = parsePoint(fields[6], fields[7], lineNumber);
+                    break;
+                case TraceOp::LOCATION_UPDATE:
+                    record.point = parsePoint(fields[3], fields[4], lineNumber);
+                    break;
+                case TraceOp::REQUEST_RIDE:
+                    record.detail = fields[3];
+                    record.point = parsePoint(fields[4], fields[5], lineNumber);
+                    record.dropoff = parsePoint(fields[6], fields[7], lineNumber);
+                    record.rideType = fields[8] == "CARPOOL" ? RideType::CARPOOL : RideType::NORMAL;
+                    record.vehicleType = parseName<VehicleType>(fields[9], vehicleTypeNames(), 4, lineNumber);
+                    record.count = std::atoi(fields[10].c_str());
+                    break;
+                case TraceOp::UPDATE_RIDE_STATUS:
+                    record.status = parseName<RideStatus>(fields[3], statusNames(), 6, lineNumber);
+                    break;
+            }
+            records.push_back(std::move(record));
+        }
+        return records;
+    }
+
+    static void writeCsv(std::ostream& output, const std::vector<TraceRecord>& records) {
+        output << std::fixed << std::setprecision(6);
+        for (const auto& record : records) {
+            output << record.timestampMs << ',' << opNames()[static_cast<int>(record.op)];
+            writeText(output, record.subject);
+            switch (record.op) {
+                case TraceOp::REGISTER_RIDER:
+                    writeText(output, record.detail);
+                    break;
+                case TraceOp::REGISTER_DRIVER:
+                    writeText(output, record.detail);
+                    output << ',' << vehicleTypeNames()[static_cast<int>(record.vehicleType)]
+                           << ',' << record.count;
+                    writePoint(output, record.point);
+                    break;
+                case TraceOp::LOCATION_UPDATE:
+                    writePoint(output, record.point);
+                    break;
+                case TraceOp::REQUEST_RIDE:
+                    writeText(output, record.detail);
+                    writePoint(output, record.point);
+                    writePoint(output, record.dropoff);
+                    output << ',' << (record.rideType == RideType::CARPOOL ? "CARPOOL" : "NORMAL") << ','
+                           << vehicleTypeNames()[static_cast<int>(record.vehicleType)] << ',' << record.count;
+                    break;
+                case TraceOp::UPDATE_RIDE_STATUS:
+                    output << ',' << statusNames()[static_cast<int>(record.status)];
+                    break;
+            }
+            output << '\n';
+        }
+    }
+
+    static std::vector<std::uint8_t> encode(const std::vector<TraceRecord>& records) {
+        std::vector<std::string> strings;
+        std::unordered_map<std::string, std::uint32_t> stringIds;
+        auto intern = [&](const std::string& value) {
+            auto it = stringIds.emplace(value, static_cast<std::uint32_t>(strings.size()));
+            if (it.second) {
+                strings.push_back(value);
+            }
+            return it.first->second;
+        };
+        std::vector<std::uint32_t> subjects(records.size());
+        std::vector<std::uint32_t> details(records.size());
+        for (std::size_t i = 0; i < records.size(); i++) {
+            subjects[i] = intern(records[i].subject);
+            details[i] = intern(records[i].detail);
+        }
+
+        ByteWriter out;
+        out.raw(MAGIC, sizeof(MAGIC));
+        out.varint(strings.size());
+        for (const auto& value : strings) {
+            out.string(value);
+        }
+        out.varint(records.size());
+
+        std::int64_t previousMs = 0;
+        for (std::size_t i = 0; i < records.size(); i++) {
+            const TraceRecord& record = records[i];
+            out.signedVarint(record.timestampMs - previousMs);
+            previousMs = record.timestampMs;
+            out.fixed(static_cast<std::uint8_t>(record.op), 1);
+            out.varint(subjects[i]);
+            switch (record.op) {
+                case TraceOp::REGISTER_RIDER:
+                    out.varint(details[i]);
+                    break;
+                case TraceOp::REGISTER_DRIVER:
+                    out.varint(details[i]);
+                    writeFixedPoint(out, record.point);
+                    out.fixed(static_cast<std::uint8_t>(record.vehicleType), 1);
+                    out.varint(static_cast<std::uint64_t>(record.count));
+                    break;
+                case TraceOp::LOCATION_UPDATE:
+                    writeFixedPoint(out, record.point);
+                    break;
+                case TraceOp::REQUEST_RIDE:
+                    out.varint(details[i]);
+                    writeFixedPoint(out, record.point);
+                    writeFixedPoint(out, record.dropoff);
+                    out.fixed((record.rideType == RideType::CARPOOL ? 1u : 0u) |
+                              (static_cast<unsigned>(record.vehicleType) << 1), 1);
+                    out.varint(static_cast<std::uint64_t>(record.count));
+                    break;
+                case TraceOp::UPDATE_RIDE_STATUS:
+                    out.fixed(static_cast<std::uint8_t>(record.status), 1);
+                    break;
+            }
+        }
+        return out.release();
+    }
+
+    static std::vector<TraceRecord> decode(const std::vector<std::uint8_t>& bytes) {
+        if (bytes.size() < sizeof(MAGIC) || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a RideEasy binary trace");
+        }
+        ByteReader in(bytes, "Trace file", sizeof(MAGIC));
+        std::uint64_t stringCount = in.varint();
+        in.need(stringCount); // at least one length byte each
+        std::vector<std::string> strings;
+        strings.reserve(stringCount);
+        for (std::uint64_t i = 0; i < stringCount; i++) {
+            strings.push_back(in.string());
+        }
+        auto lookup = [&](std::uint64_t id) -> const std::string& {
+            if (id >= strings.size()) {
+                throw std::runtime_error("Trace file refers to a missing string");
+            }
+            return strings[id];
+        };
+
+        std::uint64_t recordCount = in.varint();
+        std::vector<TraceRecord> records;
+        records.reserve(std::min<std::uint64_t>(recordCount, in.remaining() / 3));
+        std::int64_t timestampMs = 0;
+        for (std::uint64_t i = 0; i < recordCount; i++) {
+            TraceRecord record;
+            timestampMs += in.signedVarint();
+            record.timestampMs = timestampMs;
+            std::uint64_t op = in.fixed(1);
+            if (op > static_cast<std::uint64_t>(TraceOp::UPDATE_RIDE_STATUS)) {
+                throw std::runtime_error("Trace file has an unknown operation");
+            }
+            record.op = static_cast<TraceOp>(op);
+            record.subject = lookup(in.varint());
+            switch (record.op) {
+                case TraceOp::REGISTER_RIDER:
+                    record.detail = lookup(in.varint());
+                    break;
+                case TraceOp::REGISTER_DRIVER:
+                    record.detail = lookup(in.varint());
+                    record.point = readFixedPoint(in);
+                    record.vehicleType = static_cast<VehicleType>(in.fixed(1) & 3);
+                    record.count = static_cast<int>(in.varint());
+                    break;
+                case TraceOp::LOCATION_UPDATE:
+                    record.point = readFixedPoint(in);
+                    break;
+                case TraceOp::REQUEST_RIDE: {
+                    record.detail = lookup(in.varint());
+                    record.point = readFixedPoint(in);
+                    record.dropoff = readFixedPoint(in);
+                    unsigned flags = static_cast<unsigned>(in.fixed(1));
+                    record.rideType = (flags & 1) ? RideType::CARPOOL : RideType::NORMAL;
+                    record.vehicleType = static_cast<VehicleType>((flags >> 1) & 3);
+                    record.count = static_cast<int>(in.varint());
+                    break;
+                }
+                case TraceOp::UPDATE_RIDE_STATUS: {
+                    std::uint64_t status = in.fixed(1);
+                    if (status > static_cast<std::uint64_t>(RideStatus::CANCELLED)) {
+                        throw std::runtime_error("Trace file has an unknown ride status");
+                    }
+                    record.status = static_cast<RideStatus>(status);
+                    break;
+                }
+            }
+            records.push_back(std::move(record));
+        }
+        return records;
+    }
+
+    // Binary when the path ends in .bin, CSV otherwise
+    static void save(const std::vector<TraceRecord>& records, const std::string& path) {
+        if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0) {
+            ByteWriter::saveFile(encode(records), path);
+            return;
+        }
+        std::ofstream output(path);
+        if (!output) {
+            throw std::runtime_error("Cannot write trace file: " + path);
+        }
+        writeCsv(output, records);
+    }
+
+    static std::vector<TraceRecord> load(const std::string& path) {
+        std::vector<std::uint8_t> bytes = ByteReader::loadFile(path);
+        if (bytes.size() >= sizeof(MAGIC) && std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) == 0) {
+            return decode(bytes);
+        }
+        std::istringstream input(std::string(bytes.begin(), bytes.end()));
+        return readCsv(input);
+    }
+};
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef TRACE_REPLAYER_H
+#define TRACE_REPLAYER_H
+
+#include "RideManager.h"
+#include "Trace.h"
+#include "GeoUtils.h"
+#include "LatencyStats.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+
+struct ReplayReport {
+    OperationStats operations[5]; // indexed by TraceOp
+    std::size_t records = 0;
+    double wallSeconds = 0.0;
+    double traceSeconds = 0.0;     // span between the first and last record
+    std::int64_t maxLagNs = 0;     // how far behind schedule a paced replay fell
+    std::size_t unknownRides = 0;  // status updates for rides whose request failed
+
+    std::size_t errorCount() const {
+        std::size_t total = 0;
+        for (const auto& operation : operations) {
+            total += operation.errors;
+        }
+        return total;
+    }
+};
+
+// Drives RideManager with a recorded trace. With a speed factor each record
+// is issued when (its timestamp - the first timestamp) / speed has elapsed;
+// speed 0 replays as fast as possible. The engine clock is set to each
+// record's timestamp before it is issued, so time-dependent behaviour (dead
+// reckoning, trails) follows the trace rather than the wall clock.
+class TraceReplayer {
+private:
+    RideManager& engine;
+    std::unordered_map<std::string, std::string> liveRideIds; // recorded ride ID -> engine ride ID
+    std::shared_ptr<std::atomic<std::int64_t>> traceNow;
+
+    // True if the call was made (even if it threw); false if it could not be issued
+    bool issue(const TraceRecord& record, ReplayReport& report) {
+        switch (record.op) {
+            case TraceOp::REGISTER_RIDER:
+                engine.registerRider(std::make_shared<Rider>(record.subject, record.detail, "0"));
+                return true;
+            case TraceOp::REGISTER_DRIVER:
+                engine.registerDriver(std::make_shared<Driver>(
+                    record.subject, record.detail, "0",
+                    Vehicle("V" + record.subject, "Replay", record.subject,
+                            VehicleTypeFactory::getVehicleTypeName(record.vehicleType), record.count),
+                    GeoUtils::toLocation(record.point)));
+                return true;
+            case TraceOp::LOCATION_UPDATE:
+                engine.updateDriverLocation(record.subject, record.point.latitude(), record.point.longitude(),
+                                            record.timestampMs);
+                return true;
+            case TraceOp::REQUEST_RIDE:
+                liveRideIds[record.subject] = engine.requestRide(
+                    record.detail, GeoUtils::toLocation(record.point), GeoUtils::toLocation(record.dropoff),
+                    record.rideType, record.vehicleType, record.count);
+                return true;
+            case TraceOp::UPDATE_RIDE_STATUS: {
+                auto it = liveRideIds.find(record.subject);
+                if (it == liveRideIds.end()) {
+                    report.unknownRides++;
+                    return false;
+                }
+                engine.updateRideStatus(it->second, record.status);
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    explicit TraceReplayer(RideManager& engine)
+        : engine(engine), traceNow(std::make_shared<std::atomic<std::int64_t>>(0)) {}
+
+    ReplayReport replay(const std::vector<TraceRecord>& records, double speed) {
+        ReplayReport report;
+        if (records.empty()) {
+            return report;
+        }
+        auto now = traceNow;
+        engine.setClock([now]() { return now->load(std::memory_order_relaxed); });
+
+        std::int64_t firstMs = records.front().timestampMs;
+        report.traceSeconds = (records.back().timestampMs - firstMs) / 1000.0;
+        for (auto& operation : report.operations) {
+            operation.latenciesNs.reserve(records.size() / 4);
+        }
+
+        auto wallStart = std::chrono::steady_clock::now();
+        for (const auto& record : records) {
+            if (speed > 0.0) {
+                auto due = wallStart + std::chrono::nanoseconds(
+                    static_cast<std::int64_t>((record.timestampMs - firstMs) * 1e6 / speed));
+                std::this_thread::sleep_until(due);
+                report.maxLagNs = std::max<std::int64_t>(
+                    report.maxLagNs,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - due)
+                        .count());
+            }
+            traceNow->store(record.timestampMs, std::memory_order_relaxed);
+
+            OperationStats& stats = report.operations[static_cast<int>(record.op)];
+            auto start = std::chrono::steady_clock::now();
+            try {
+                if (!issue(record, report)) {
+                    continue;
+                }
+            } catch (const std::exception&) {
+                stats.errors++;
+            }
+            stats.latenciesNs.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            report.records++;
+        }
+        report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        return report;
+    }
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+
+// Runs a batch of independent tasks on a fixed set of threads. Tasks are dealt
+// round-robin into per-worker deques; a worker takes from the back of its own
+// deque and, once that is empty, steals from the front of the others, so a
+// worker that drew short tasks keeps helping until the whole batch is done.
+// Tasks must not throw; wrap them if they can.
+class WorkStealingPool {
+private:
+    struct WorkerQueue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::size_t threadCount;
+
+    static bool popBack(WorkerQueue& queue, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    static bool stealFront(WorkerQueue& queue, std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+public:
+    explicit WorkStealingPool(std::size_t threads = std::thread::hardware_concurrency())
+        : threadCount(std::max<std::size_t>(1, threads)) {}
+
+    std::size_t getThreadCount() const { return threadCount; }
+
+    // Blocks until every task has run; returns how many tasks each worker stole
+    std::vector<std::size_t> run(std::vector<std::function<void()>> tasks) {
+        std::size_t workers = std::min(threadCount, std::max<std::size_t>(1, tasks.size()));
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        for (std::size_t w = 0; w < workers; w++) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (std::size_t i = 0; i < tasks.size(); i++) {
+            queues[i % workers]->tasks.push_back(std::move(tasks[i]));
+        }
+
+        // No task adds work, so a worker that finds every queue empty is done
+        std::vector<std::size_t> steals(workers, 0);
+        auto work = [&](std::size_t self) {
+            std::function<void()> task;
+            for (;;) {
+                if (popBack(*queues[self], task)) {
+                    task();
+                    continue;
+                }
+                bool stole = false;
+                for (std::size_t offset = 1; offset < workers && !stole; offset++) {
+                    stole = stealFront(*queues[(self + offset) % workers], task);
+                }
+                if (!stole) {
+                    return;
+                }
+                steals[self]++;
+                task();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t w = 1; w < workers; w++) {
+            threads.emplace_back(work, w);
+        }
+        work(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return steals;
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "User.h"
+#include "RideTypes.h"
+#include "BinaryIO.h"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+struct SimDriverSpec {
+    GeoPoint position;
+    VehicleType vehicleType;
+};
+
+struct SimRideRequest {
+    std::int64_t offsetMs; // since the start of the simulation
+    GeoPoint pickup;
+    GeoPoint dropoff;
+    RideType rideType;
+    VehicleType vehicleType;
+    int passengerCount;
+};
+
+// A fleet plus a demand stream, as read by the simulator and benchmarks
+struct Workload {
+    std::uint64_t seed = 0;
+    std::int64_t durationMs = 0;
+    std::uint32_t riderCount = 1;
+    std::vector<SimDriverSpec> drivers;
+    std::vector<SimRideRequest> requests; // ordered by offsetMs
+};
+
+// Compact binary workload files. Integers are little-endian; requests store
+// the arrival gap and the dropoff as zigzag varint deltas (from the previous
+// request and from the pickup), so a typical request takes about 16 bytes.
+//
+//     "RIDEWKL1" seed:u64 durationMs:i64 riders:u32 drivers:u32 requests:u32
+//     driver:  latE6:i32 lngE6:i32 vehicleType:u8
+//     request: gapMs:varint pickupLatE6:i32 pickupLngE6:i32
+//              dLatE6:zigzag dLngE6:zigzag flags:u8
+//     flags:   bit 0 carpool, bits 1-2 vehicle type, bits 3-7 passengers
+class WorkloadFile {
+private:
+    static constexpr char MAGIC[8] = {'R', 'I', 'D', 'E', 'W', 'K', 'L', '1'};
+
+public:
+    static std::vector<std::uint8_t> encode(const Workload& workload) {
+        ByteWriter out;
+        out.reserve(40 + workload.drivers.size() * 9 + workload.requests.size() * 16);
+        out.raw(MAGIC, sizeof(MAGIC));
+        out.fixed(workload.seed, 8);
+        out.fixed(static_cast<std::uint64_t>(workload.durationMs), 8);
+        out.fixed(workload.riderCount, 4);
+        out.fixed(workload.drivers.size(), 4);
+        out.fixed(workload.requests.size(), 4);
+
+        for (const auto& driver : workload.drivers) {
+            out.fixed(static_cast<std::uint32_t>(driver.position.latitudeE6), 4);
+            out.fixed(static_cast<std::uint32_t>(driver.position.longitudeE6), 4);
+            out.fixed(static_cast<std::uint8_t>(driver.vehicleType), 1);
+        }
+
+        std::int64_t previousMs = 0;
+        for (const auto& request : workload.requests) {
+            if (request.offsetMs < previousMs) {
+                throw std::invalid_argument("Workload requests must be ordered by arrival time");
+            }
+            if (request.passengerCount < 1 || request.passengerCount > 31) {
+                throw std::invalid_argument("Workload passenger counts must be between 1 and 31");
+            }
+            out.varint(static_cast<std::uint64_t>(request.offsetMs - previousMs));
+            previousMs = request.offsetMs;
+            out.fixed(static_cast<std::uint32_t>(request.pickup.latitudeE6), 4);
+            out.fixed(static_cast<std::uint32_t>(request.pickup.longitudeE6), 4);
+            out.signedVarint(static_cast<std::int64_t>(request.dropoff.latitudeE6) - request.pickup.latitudeE6);
+            out.signedVarint(static_cast<std::int64_t>(request.dropoff.longitudeE6) - request.pickup.longitudeE6);
+            out.fixed((request.rideType == RideType::CARPOOL ? 1u : 0u) |
+                      (static_cast<unsigned>(request.vehicleType) << 1) |
+                      (static_cast<unsigned>(request.passengerCount) << 3), 1);
+        }
+        return out.release();
+    }
+
+    static Workload decode(const std::vector<std::uint8_t>& bytes) {
+        if (bytes.size() < sizeof(MAGIC) || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a RideEasy workload file");
+        }
+        ByteReader in(bytes, "Workload file", sizeof(MAGIC));
+        Workload workload;
+        workload.seed = in.fixed(8);
+        workload.durationMs = static_cast<std::int64_t>(in.fixed(8));
+        workload.riderCount = static_cast<std::uint32_t>(in.fixed(4));
+        std::uint32_t driverCount = static_cast<std::uint32_t>(in.fixed(4));
+        std::uint32_t requestCount = static_cast<std::uint32_t>(in.fixed(4));
+
+        // Sizes are only trusted once the bytes to back them are known to exist
+        in.need(static_cast<std::size_t>(driverCount) * 9);
+        workload.drivers.reserve(driverCount);
+        for (std::uint32_t i = 0; i < driverCount; i++) {
+            SimDriverSpec driver;
+            driver.position.latitudeE6 = static_cast<std::int32_t>(in.fixed(4));
+            driver.position.longitudeE6 = static_cast<std::int32_t>(in.fixed(4));
+            driver.vehicleType = static_cast<VehicleType>(in.fixed(1) & 3);
+            workload.drivers.push_back(driver);
+        }
+
+        workload.requests.reserve(std::min<std::size_t>(requestCount, in.remaining() / 12));
+        std::int64_t offsetMs = 0;
+        for (std::uint32_t i = 0; i < requestCount; i++) {
+            SimRideRequest request;
+            offsetMs += static_cast<std::int64_t>(in.varint());
+            request.offsetMs = offsetMs;
+            request.pickup.latitudeE6 = static_cast<std::int32_t>(in.fixed(4));
+            request.pickup.longitudeE6 = static_cast<std::int32_t>(in.fixed(4));
+            request.dropoff.latitudeE6 = static_cast<std::int32_t>(request.pickup.latitudeE6 + in.signedVarint());
+            request.dropoff.longitudeE6 = static_cast<std::int32_t>(request.pickup.longitudeE6 + in.signedVarint());
+            unsigned flags = static_cast<unsigned>(in.fixed(1));
+            request.rideType = (flags & 1) ? RideType::CARPOOL : RideType::NORMAL;
+            request.vehicleType = static_cast<VehicleType>((flags >> 1) & 3);
+            request.passengerCount = static_cast<int>(flags >> 3);
+            workload.requests.push_back(request);
+        }
+        return workload;
+    }
+
+    // Returns the file size in bytes
+    static std::size_t save(const Workload& workload, const std::string& path) {
+        std::vector<std::uint8_t> bytes = encode(workload);
+        ByteWriter::saveFile(bytes, path);
+        return bytes.size();
+    }
+
+    static Workload load(const std::string& path) {
+        return decode(ByteReader::loadFile(path));
+    }
+};
+
+#endif
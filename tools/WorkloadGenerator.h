@@ -0,0 +1,205 @@
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include "Workload.h"
+#include <vector>
+#include <string>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+
+enum class HotspotKind {
+    STATION,  // busy all day, sharper at commute peaks
+    AIRPORT,  // steady, with late-night flights
+    BUSINESS  // destination in the morning, origin in the evening
+};
+
+struct Hotspot {
+    std::string name;
+    HotspotKind kind;
+    GeoPoint centre;
+    double radiusKm;
+    double weight; // relative popularity among hotspots
+};
+
+struct WorkloadSpec {
+    std::uint64_t seed = 42;
+    double durationHours = 24.0;
+    std::size_t drivers = 2000;
+    double ridesPerDay = 100000.0;   // expected arrivals over a full day of the curve
+    std::size_t riders = 0;          // 0 means one rider per ten requests
+    double hotspotShare = 0.55;      // trip ends drawn from hotspots, the rest uniform
+    double carpoolShare = 0.10;      // of eligible (non-bike, at most two passenger) requests
+    double vehicleMix[4] = {0.25, 0.35, 0.10, 0.30}; // BIKE, SEDAN, SUV, AUTO_RICKSHAW demand
+    double fleetMix[4] = {0.25, 0.35, 0.10, 0.30};   // same order, for drivers
+
+    // City bounding box in degrees
+    double minLatitude = 18.90;
+    double maxLatitude = 19.25;
+    double minLongitude = 72.80;
+    double maxLongitude = 73.00;
+    std::vector<Hotspot> hotspots;
+
+    // Relative demand for each hour of the day; peaks at 9:00 and 19:00
+    double hourlyDemand[24] = {0.30, 0.20, 0.15, 0.12, 0.15, 0.30, 0.60, 1.00, 1.50, 1.70, 1.30, 1.00,
+                               1.00, 1.00, 0.95, 1.00, 1.20, 1.50, 1.80, 1.90, 1.50, 1.10, 0.80, 0.50};
+
+    // Mumbai: main rail stations, the airport and the business districts
+    static WorkloadSpec mumbai() {
+        WorkloadSpec spec;
+        spec.hotspots = {
+            {"CSMT", HotspotKind::STATION, GeoPoint::fromDegrees(18.9398, 72.8355), 0.8, 1.0},
+            {"Dadar", HotspotKind::STATION, GeoPoint::fromDegrees(19.0178, 72.8478), 0.8, 1.2},
+            {"Andheri", HotspotKind::STATION, GeoPoint::fromDegrees(19.1197, 72.8464), 0.8, 1.2},
+            {"Airport", HotspotKind::AIRPORT, GeoPoint::fromDegrees(19.0896, 72.8656), 1.0, 1.0},
+            {"BKC", HotspotKind::BUSINESS, GeoPoint::fromDegrees(19.0660, 72.8650), 1.2, 1.3},
+            {"Lower Parel", HotspotKind::BUSINESS, GeoPoint::fromDegrees(18.9977, 72.8258), 1.0, 1.0},
+            {"Nariman Point", HotspotKind::BUSINESS, GeoPoint::fromDegrees(18.9256, 72.8242), 0.8, 0.8},
+            {"Powai", HotspotKind::BUSINESS, GeoPoint::fromDegrees(19.1176, 72.9060), 1.2, 0.9},
+        };
+        return spec;
+    }
+};
+
+// Synthetic fleet and demand for one city. Arrivals are a non-homogeneous
+// Poisson process following the hourly demand curve (generated by thinning a
+// process at the peak rate). Trip ends come from hotspots whose pull depends
+// on their kind, the hour and whether the end is a pickup or a dropoff, or
+// uniformly from the bounding box; the result is fully determined by the seed.
+class WorkloadGenerator {
+private:
+    WorkloadSpec spec;
+    std::mt19937_64 gen;
+
+    static double hotspotPull(HotspotKind kind, int hour, bool pickup) {
+        bool morning = hour >= 7 && hour < 11;
+        bool evening = hour >= 17 && hour < 21;
+        switch (kind) {
+            case HotspotKind::STATION:
+                return (morning || evening) ? 1.5 : 1.0;
+            case HotspotKind::AIRPORT:
+                return (hour >= 22 || hour < 5) ? 2.0 : 1.0;
+            case HotspotKind::BUSINESS:
+                if (morning) return pickup ? 0.3 : 2.5;
+                if (evening) return pickup ? 2.5 : 0.3;
+                return hour >= 11 && hour < 17 ? 1.0 : 0.2;
+        }
+        return 1.0;
+    }
+
+    GeoPoint clampToCity(double latitude, double longitude) const {
+        return GeoPoint::fromDegrees(std::min(std::max(latitude, spec.minLatitude), spec.maxLatitude),
+                                     std::min(std::max(longitude, spec.minLongitude), spec.maxLongitude));
+    }
+
+    GeoPoint uniformPoint() {
+        std::uniform_real_distribution<> latitude(spec.minLatitude, spec.maxLatitude);
+        std::uniform_real_distribution<> longitude(spec.minLongitude, spec.maxLongitude);
+        return GeoPoint::fromDegrees(latitude(gen), longitude(gen));
+    }
+
+    // Gaussian scatter around the centre, radiusKm being one standard deviation
+    GeoPoint nearHotspot(const Hotspot& hotspot) {
+        const double pi = 3.14159265358979323846;
+        std::normal_distribution<> offsetKm(0.0, hotspot.radiusKm);
+        double cosLatitude = std::cos(hotspot.centre.latitude() * pi / 180.0);
+        return clampToCity(hotspot.centre.latitude() + offsetKm(gen) / 111.0,
+                           hotspot.centre.longitude() + offsetKm(gen) / (111.0 * cosLatitude));
+    }
+
+    GeoPoint tripEnd(int hour, bool pickup) {
+        if (spec.hotspots.empty() || std::uniform_real_distribution<>(0.0, 1.0)(gen) >= spec.hotspotShare) {
+            return uniformPoint();
+        }
+        return hotspotPoint(hour, pickup);
+    }
+
+    // Near a hotspot picked by weight and time-of-day pull; needs at least one hotspot
+    GeoPoint hotspotPoint(int hour, bool pickup) {
+        std::vector<double> weights;
+        weights.reserve(spec.hotspots.size());
+        for (const auto& hotspot : spec.hotspots) {
+            weights.push_back(hotspot.weight * hotspotPull(hotspot.kind, hour, pickup));
+        }
+        std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+        return nearHotspot(spec.hotspots[pick(gen)]);
+    }
+
+    int passengersFor(VehicleType type) {
+        switch (type) {
+            case VehicleType::BIKE: return 1;
+            case VehicleType::AUTO_RICKSHAW: return std::uniform_int_distribution<int>(1, 2)(gen);
+            case VehicleType::SUV: return std::uniform_int_distribution<int>(1, 5)(gen);
+            default: return std::uniform_int_distribution<int>(1, 3)(gen);
+        }
+    }
+
+public:
+    explicit WorkloadGenerator(const WorkloadSpec& spec) : spec(spec), gen(spec.seed) {
+        if (spec.durationHours <= 0.0 || spec.ridesPerDay < 0.0) {
+            throw std::invalid_argument("Workload duration must be positive and demand non-negative");
+        }
+        if (spec.minLatitude >= spec.maxLatitude || spec.minLongitude >= spec.maxLongitude) {
+            throw std::invalid_argument("Workload bounding box is empty");
+        }
+    }
+
+    Workload generate() {
+        Workload workload;
+        workload.seed = spec.seed;
+        workload.durationMs = static_cast<std::int64_t>(spec.durationHours * 3600000.0);
+
+        // Fleet: half parked near hotspots, the rest spread over the city
+        std::discrete_distribution<int> fleetType(std::begin(spec.fleetMix), std::end(spec.fleetMix));
+        workload.drivers.reserve(spec.drivers);
+        for (std::size_t i = 0; i < spec.drivers; i++) {
+            GeoPoint position = (i % 2 == 0 && !spec.hotspots.empty()) ? hotspotPoint(12, true) : uniformPoint();
+            workload.drivers.push_back({position, static_cast<VehicleType>(fleetType(gen))});
+        }
+
+        double curveTotal = 0.0;
+        double curvePeak = 0.0;
+        for (double demand : spec.hourlyDemand) {
+            curveTotal += demand;
+            curvePeak = std::max(curvePeak, demand);
+        }
+        if (curvePeak <= 0.0 || spec.ridesPerDay == 0.0) {
+            workload.riderCount = static_cast<std::uint32_t>(std::max<std::size_t>(1, spec.riders));
+            return workload;
+        }
+
+        // Thinning: candidates at the peak rate, kept with probability demand / peak
+        double peakPerMs = spec.ridesPerDay * curvePeak / (curveTotal * 3600000.0);
+        std::exponential_distribution<> gap(peakPerMs);
+        std::uniform_real_distribution<> unit(0.0, 1.0);
+        std::discrete_distribution<int> demandType(std::begin(spec.vehicleMix), std::end(spec.vehicleMix));
+        workload.requests.reserve(static_cast<std::size_t>(spec.ridesPerDay * spec.durationHours / 24.0 * 1.05));
+
+        for (double offsetMs = gap(gen); offsetMs < workload.durationMs; offsetMs += gap(gen)) {
+            int hour = static_cast<int>(offsetMs / 3600000.0) % 24;
+            if (unit(gen) * curvePeak >= spec.hourlyDemand[hour]) {
+                continue;
+            }
+
+            SimRideRequest request;
+            request.offsetMs = static_cast<std::int64_t>(offsetMs);
+            request.pickup = tripEnd(hour, true);
+            do {
+                request.dropoff = tripEnd(hour, false);
+            } while (request.dropoff == request.pickup);
+            request.vehicleType = static_cast<VehicleType>(demandType(gen));
+            request.passengerCount = passengersFor(request.vehicleType);
+            bool carpoolable = request.vehicleType != VehicleType::BIKE && request.passengerCount <= 2;
+            request.rideType = carpoolable && unit(gen) < spec.carpoolShare ? RideType::CARPOOL : RideType::NORMAL;
+            workload.requests.push_back(request);
+        }
+
+        std::size_t riders = spec.riders > 0 ? spec.riders : std::max<std::size_t>(1, workload.requests.size() / 10);
+        workload.riderCount = static_cast<std::uint32_t>(riders);
+        return workload;
+    }
+};
+
+#endif
@@ -0,0 +1,331 @@
+// RideEasy micro-benchmarks for the engine's hot paths: requestRide,
+// updateRideStatus, completeRide and notifyObservers (per fleet size and
+// observer count), every pricing stack (decorator chain and compiled) and
+// every matching strategy. Results are JSON lines (or CSV) for tooling; a
+// build with RIDEEASY_TRACK_ALLOCATIONS adds heap allocations and bytes per
+// operation, and --perf on adds Linux hardware counters per operation.
+
+#include "BenchHarness.h"
+#include "RideManager.h"
+#include "MatchingStrategy.h"
+#include "PricingStrategy.h"
+#include "CompiledPricing.h"
+#include "Observer.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_bench [--drivers 100,1000,10000] [--observers 0,1,8]\n"
+    "                      [--min-time S] [--filter NAME] [--format json|csv]\n"
+    "                      [--out FILE] [--seed N] [--perf on|off]\n";
+
+// Observer doing the least a real one would: look at the message
+class CountingObserver : public Observer {
+public:
+    std::size_t bytesSeen = 0;
+
+    void update(const std::string& event, const std::string& message) override {
+        bytesSeen += event.size() + message.size();
+    }
+};
+
+struct BenchCity {
+    RideManager& engine;
+    std::mt19937_64 gen;
+    std::vector<std::shared_ptr<Driver>> drivers;
+    std::vector<std::string> riderIds;
+    std::uniform_real_distribution<> latitude{18.90, 19.25};
+    std::uniform_real_distribution<> longitude{72.80, 73.00};
+
+    BenchCity(RideManager& engine, std::uint64_t seed) : engine(engine), gen(seed) {}
+
+    Location randomLocation() { return Location(latitude(gen), longitude(gen)); }
+
+    VehicleType randomVehicleType() {
+        return static_cast<VehicleType>(std::uniform_int_distribution<int>(0, 3)(gen));
+    }
+
+    void growFleet(std::size_t count) {
+        static const int capacities[] = {1, 4, 6, 3}; // BIKE, SEDAN, SUV, AUTO_RICKSHAW
+        std::uniform_real_distribution<> rating(3.0, 5.0);
+        for (std::size_t i = drivers.size(); i < count; i++) {
+            VehicleType type = randomVehicleType();
+            auto driver = std::make_shared<Driver>(
+                "BD" + std::to_string(i), "Bench Driver " + std::to_string(i), "0",
+                Vehicle("BV" + std::to_string(i), "Bench", "BENCH-" + std::to_string(i),
+                        VehicleTypeFactory::getVehicleTypeName(type), capacities[static_cast<int>(type)]),
+                randomLocation());
+            driver->setRating(rating(gen));
+            engine.registerDriver(driver);
+            drivers.push_back(driver);
+        }
+        for (std::size_t i = riderIds.size(); i < 1000; i++) {
+            riderIds.push_back("BR" + std::to_string(i));
+            engine.registerRider(std::make_shared<Rider>(riderIds.back(), "Bench Rider " + std::to_string(i), "0"));
+        }
+    }
+
+    std::string requestRide() {
+        const std::string& riderId = riderIds[std::uniform_int_distribution<std::size_t>(0, riderIds.size() - 1)(gen)];
+        Location pickup = randomLocation();
+        Location dropoff = randomLocation();
+        return engine.requestRide(riderId, pickup, dropoff, RideType::NORMAL, randomVehicleType(), 1);
+    }
+
+    // Frees the ride's driver again
+    void finish(const std::string& rideId) {
+        auto ride = engine.getRide(rideId);
+        engine.updateRideStatus(rideId, ride && ride->getDriver() ? RideStatus::COMPLETED : RideStatus::CANCELLED);
+    }
+};
+
+static std::vector<std::size_t> parseList(const std::string& text) {
+    std::vector<std::size_t> values;
+    std::istringstream list(text);
+    std::string value;
+    while (std::getline(list, value, ',')) {
+        values.push_back(std::strtoull(value.c_str(), nullptr, 10));
+    }
+    return values;
+}
+
+// Rides are created and finished in small groups so the fleet never runs dry
+static const std::uint64_t RIDE_GROUP = 32;
+
+static void engineBenchmarks(BenchHarness& harness, BenchCity& city, const BenchParams& params) {
+    harness.run("requestRide", params, [&](std::uint64_t operations) {
+        std::int64_t timedNs = 0;
+        std::vector<std::string> rideIds;
+        for (std::uint64_t done = 0; done < operations; done += rideIds.size()) {
+            rideIds.clear();
+            std::uint64_t group = std::min(RIDE_GROUP, operations - done);
+            auto start = BenchHarness::mark();
+            for (std::uint64_t i = 0; i < group; i++) {
+                rideIds.push_back(city.requestRide());
+            }
+            timedNs += BenchHarness::elapsedNs(start);
+            for (const auto& rideId : rideIds) {
+                city.finish(rideId);
+            }
+        }
+        return timedNs;
+    });
+
+    harness.run("updateRideStatus", params, [&](std::uint64_t operations) {
+        std::int64_t timedNs = 0;
+        std::vector<std::string> rideIds;
+        for (std::uint64_t done = 0; done < operations; done += rideIds.size()) {
+            rideIds.clear();
+            std::uint64_t group = std::min(RIDE_GROUP, operations - done);
+            for (std::uint64_t i = 0; i < group; i++) {
+                rideIds.push_back(city.requestRide());
+            }
+            auto start = BenchHarness::mark();
+            for (const auto& rideId : rideIds) {
+                city.engine.updateRideStatus(rideId, RideStatus::DRIVER_ENROUTE);
+            }
+            timedNs += BenchHarness::elapsedNs(start);
+            for (const auto& rideId : rideIds) {
+                city.finish(rideId);
+            }
+        }
+        return timedNs;
+    });
+
+    harness.run("completeRide", params, [&](std::uint64_t operations) {
+        std::int64_t timedNs = 0;
+        std::vector<std::string> rideIds;
+        for (std::uint64_t done = 0; done < operations; done += rideIds.size()) {
+            rideIds.clear();
+            std::uint64_t group = std::min(RIDE_GROUP, operations - done);
+            for (std::uint64_t i = 0; i < group; i++) {
+                rideIds.push_back(city.requestRide());
+                city.engine.updateRideStatus(rideIds.back(), RideStatus::IN_PROGRESS);
+            }
+            auto start = BenchHarness::mark();
+            for (const auto& rideId : rideIds) {
+                city.engine.completeRide(rideId); // releases the driver itself
+            }
+            timedNs += BenchHarness::elapsedNs(start);
+        }
+        return timedNs;
+    });
+
+    harness.run("notifyObservers", params, [&](std::uint64_t operations) {
+        std::string message = "Ride RIDE_1 status updated";
+        auto start = BenchHarness::mark();
+        for (std::uint64_t i = 0; i < operations; i++) {
+            city.engine.notifyObservers("RIDE_STATUS_UPDATE", message);
+        }
+        return BenchHarness::elapsedNs(start);
+    });
+}
+
+static void matchingBenchmarks(BenchHarness& harness, BenchCity& city, std::size_t fleet) {
+    std::vector<std::shared_ptr<Driver>> candidates(city.drivers.begin(), city.drivers.begin() + fleet);
+    std::vector<GeoPoint> positions;
+    for (const auto& driver : candidates) {
+        positions.push_back(driver->getPosition());
+    }
+    std::vector<Location> pickups;
+    std::vector<VehicleType> types;
+    for (int i = 0; i < 1024; i++) {
+        pickups.push_back(city.randomLocation());
+        types.push_back(city.randomVehicleType());
+    }
+
+    std::vector<std::pair<std::string, std::unique_ptr<MatchingStrategy>>> strategies;
+    strategies.emplace_back("NearestDriverStrategy", std::make_unique<NearestDriverStrategy>());
+    strategies.emplace_back("BestRatedDriverStrategy", std::make_unique<BestRatedDriverStrategy>());
+
+    for (auto& strategy : strategies) {
+        MatchingStrategy& matcher = *strategy.second;
+        harness.run("match/" + strategy.first, {"legacy", fleet, 0}, [&](std::uint64_t operations) {
+            auto start = BenchHarness::mark();
+            for (std::uint64_t i = 0; i < operations; i++) {
+                auto driver = matcher.findBestDriver(candidates, pickups[i % 1024], types[i % 1024]);
+                benchKeep(driver.get());
+            }
+            return BenchHarness::elapsedNs(start);
+        });
+        harness.run("match/" + strategy.first, {"positions", fleet, 0}, [&](std::uint64_t operations) {
+            auto start = BenchHarness::mark();
+            for (std::uint64_t i = 0; i < operations; i++) {
+                GeoPoint pickup = GeoPoint::fromDegrees(pickups[i % 1024].latitude, pickups[i % 1024].longitude);
+                auto driver = matcher.findBestDriver(candidates, positions, pickup, types[i % 1024]);
+                benchKeep(driver.get());
+            }
+            return BenchHarness::elapsedNs(start);
+        });
+    }
+}
+
+static void pricingBenchmarks(BenchHarness& harness, std::uint64_t seed) {
+    std::vector<std::pair<std::string, PricingPlan>> stacks = {
+        {"base", PricingPlan()},
+        {"surge", PricingPlan().surge(1.8)},
+        {"discount", PricingPlan().discount(15.0)},
+        {"toll", PricingPlan().toll(40.0)},
+        {"surge+discount", PricingPlan().surge(1.8).discount(15.0)},
+        {"surge+discount+toll", PricingPlan().surge(1.8).discount(15.0).toll(40.0)},
+    };
+
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<> distance(0.5, 40.0);
+    std::vector<double> distances(4096);
+    std::vector<VehicleType> types(4096);
+    for (std::size_t i = 0; i < distances.size(); i++) {
+        distances[i] = distance(gen);
+        types[i] = static_cast<VehicleType>(i % 4);
+    }
+
+    for (const auto& stack : stacks) {
+        std::unique_ptr<PricingCalculator> calculators[2] = {stack.second.buildDecoratorChain(),
+                                                             std::make_unique<CompiledPricingCalculator>(stack.second)};
+        const char* variants[2] = {"decorator", "compiled"};
+        for (int v = 0; v < 2; v++) {
+            PricingCalculator& calculator = *calculators[v];
+            harness.run("pricing/" + stack.first, {variants[v], 0, 0}, [&](std::uint64_t operations) {
+                double total = 0.0;
+                auto start = BenchHarness::mark();
+                for (std::uint64_t i = 0; i < operations; i++) {
+                    total += calculator.calculateFare(distances[i % 4096], types[i % 4096]);
+                }
+                std::int64_t ns = BenchHarness::elapsedNs(start);
+                benchKeep(total);
+                return ns;
+            });
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> fleets = {100, 1000, 10000};
+    std::vector<std::size_t> observerCounts = {0, 1, 8};
+    double minSeconds = 0.2;
+    std::string filter;
+    std::string format = "json";
+    std::string outputPath;
+    std::uint64_t seed = 42;
+    bool perf = false;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--drivers") fleets = parseList(argv[i + 1]);
+        else if (arg == "--observers") observerCounts = parseList(argv[i + 1]);
+        else if (arg == "--min-time") minSeconds = std::atof(argv[i + 1]);
+        else if (arg == "--filter") filter = argv[i + 1];
+        else if (arg == "--format") format = argv[i + 1];
+        else if (arg == "--out") outputPath = argv[i + 1];
+        else if (arg == "--seed") seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--perf") perf = std::string(argv[i + 1]) == "on";
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (format != "json" && format != "csv") {
+        std::cerr << "--format must be json or csv" << std::endl;
+        return 1;
+    }
+    // The engine is a singleton, so fleets only ever grow: run them smallest first
+    std::sort(fleets.begin(), fleets.end());
+    fleets.erase(std::remove(fleets.begin(), fleets.end(), 0), fleets.end());
+
+    BenchHarness harness(minSeconds, filter);
+    if (perf) {
+        std::string error = harness.enableHardwareCounters();
+        if (!error.empty()) {
+            std::cerr << "Hardware counters unavailable (" << error << "), reporting time only" << std::endl;
+        }
+    }
+    RideManager& engine = RideManager::getInstance();
+    engine.setRandomSeed(static_cast<std::uint32_t>(seed));
+    BenchCity city(engine, seed);
+
+    pricingBenchmarks(harness, seed);
+    for (std::size_t fleet : fleets) {
+        city.growFleet(fleet);
+        matchingBenchmarks(harness, city, fleet);
+        for (std::size_t observerCount : observerCounts) {
+            std::vector<std::shared_ptr<CountingObserver>> observers;
+            for (std::size_t i = 0; i < observerCount; i++) {
+                observers.push_back(std::make_shared<CountingObserver>());
+                engine.addObserver(observers.back());
+            }
+            engineBenchmarks(harness, city, {"", fleet, observerCount});
+            for (const auto& observer : observers) {
+                engine.removeObserver(observer);
+            }
+        }
+        std::cerr << "fleet " << fleet << " done" << std::endl;
+    }
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file) {
+            std::cerr << "Cannot write " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputPath.empty() ? std::cout : file;
+    if (format == "csv") {
+        harness.writeCsv(output);
+    } else {
+        harness.writeJson(output);
+    }
+    return 0;
+}
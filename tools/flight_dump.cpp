@@ -0,0 +1,84 @@
+// RideEasy flight recording decoder: prints a FlightRecorder dump (written on
+// demand, on a fatal signal or on an anomaly) as one merged timeline, newest
+// records last, with each record's age at the time of the dump.
+
+#include "FlightDump.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_flight_dump --file FILE [--last N] [--thread N]  (--last 0 prints all)\n";
+
+int main(int argc, char* argv[]) {
+    std::string path;
+    std::size_t last = 200;
+    long onlyThread = -1;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--file") path = argv[i + 1];
+        else if (arg == "--last") last = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--thread") onlyThread = std::strtol(argv[i + 1], nullptr, 10);
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << USAGE;
+        return 1;
+    }
+
+    FlightDump dump;
+    try {
+        dump = FlightDump::load(path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<FlightDump::Entry> entries;
+    for (const auto& entry : dump.timeline()) {
+        if (onlyThread < 0 || entry.threadIndex == static_cast<std::uint32_t>(onlyThread)) {
+            entries.push_back(entry);
+        }
+    }
+    std::size_t first = last > 0 && entries.size() > last ? entries.size() - last : 0;
+
+    static const char* const reasons[] = {"on demand", "fatal signal", "anomaly"};
+    std::uint32_t reason = static_cast<std::uint32_t>(dump.reason);
+    std::cout << "[FLIGHT] " << path << ": " << (reason < 3 ? reasons[reason] : "unknown");
+    if (dump.reason != FlightDumpReason::ON_DEMAND) {
+        std::cout << " (";
+        if (dump.reason == FlightDumpReason::FATAL_SIGNAL) {
+            std::cout << "signal " << dump.code;
+        } else {
+            std::cout << FlightDump::anomalyName(dump.code);
+        }
+        std::cout << ")";
+    }
+    std::cout << ", " << dump.threads.size() << " threads, " << entries.size() << " records, showing "
+              << entries.size() - first << std::endl;
+    if (dump.droppedThreads > 0) {
+        std::cout << "  [WARN] " << dump.droppedThreads << " threads found no free ring and recorded nothing"
+                  << std::endl;
+    }
+    std::cout << "  " << std::right << std::setw(12) << "ms before" << std::setw(8) << "thread" << std::setw(10)
+              << "seq" << "  " << std::left << std::setw(16) << "event" << "details" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (std::size_t i = first; i < entries.size(); i++) {
+        const FlightDump::Entry& entry = entries[i];
+        std::cout << "  " << std::right << std::setw(12) << entry.msBeforeDump << std::setw(8) << entry.threadIndex
+                  << std::setw(10) << entry.sequence << "  " << std::left << std::setw(16)
+                  << FlightDump::eventName(entry.record.event) << FlightDump::describe(entry.record) << std::endl;
+    }
+    return 0;
+}
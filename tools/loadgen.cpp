@@ -0,0 +1,242 @@
+// RideEasy open-loop load generator: issues location updates and ride requests
+// at fixed target rates from several threads, measures latency from each
+// call's intended send time (coordinated-omission corrected) and sweeps rates
+// to find the throughput knee. Ends with the engine's own per-stage latency
+// histograms over all measured runs.
+
+#include "LoadGenerator.h"
+#include "RideManager.h"
+#include "Tracing.h"
+#include "MetricsHttpServer.h"
+#include "FlightRecorder.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_loadgen [--threads N] [--duration S] [--drivers N] [--riders N]\n"
+    "                        [--location-share F] [--seed N] [--slo-us US] [--late-ms MS]\n"
+    "                        [--rates R1,R2,...] | [--sweep START:FACTOR:STEPS]\n"
+    "                        [--chrome-trace FILE]  (engine spans; needs RIDEEASY_ENABLE_TRACING)\n"
+    "                        [--metrics-port N]     (Prometheus endpoint on 127.0.0.1 while running)\n"
+    "                        [--metrics-file FILE]  (Prometheus text written at the end)\n"
+    "                        [--flight PREFIX]      (flight recorder: PREFIX.bin at the end, PREFIX-crash.bin\n"
+    "                                                on a fatal signal, PREFIX-anomaly-N.bin on anomalies)\n"
+    "                        [--flight-slow-us US]  (requestRide slower than this is an anomaly)\n";
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    std::size_t drivers = 5000;
+    std::size_t riders = 10000;
+    double sloUs = 5000.0; // corrected p99 of ride operations
+    std::vector<double> rates;
+    double sweepStart = 1000.0, sweepFactor = 2.0;
+    int sweepSteps = 8;
+    std::string chromeTracePath;
+    std::string metricsPath;
+    int metricsPort = -1;
+    std::string flightPrefix;
+    long long flightSlowUs = 0;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--threads") config.threads = static_cast<unsigned>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--duration") config.durationSeconds = std::atof(argv[i + 1]);
+        else if (arg == "--drivers") drivers = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--riders") riders = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--location-share") config.locationShare = std::atof(argv[i + 1]);
+        else if (arg == "--seed") config.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--slo-us") sloUs = std::atof(argv[i + 1]);
+        else if (arg == "--late-ms") config.lateThresholdMs = std::atof(argv[i + 1]);
+        else if (arg == "--chrome-trace") chromeTracePath = argv[i + 1];
+        else if (arg == "--metrics-port") metricsPort = std::atoi(argv[i + 1]);
+        else if (arg == "--metrics-file") metricsPath = argv[i + 1];
+        else if (arg == "--flight") flightPrefix = argv[i + 1];
+        else if (arg == "--flight-slow-us") flightSlowUs = std::atoll(argv[i + 1]);
+        else if (arg == "--rates") {
+            std::istringstream list(argv[i + 1]);
+            std::string rate;
+            while (std::getline(list, rate, ',')) {
+                rates.push_back(std::atof(rate.c_str()));
+            }
+        } else if (arg == "--sweep") {
+            char colon = 0;
+            std::istringstream spec(argv[i + 1]);
+            if (!(spec >> sweepStart >> colon >> sweepFactor >> colon >> sweepSteps)) {
+                std::cerr << "--sweep expects START:FACTOR:STEPS" << std::endl;
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (!chromeTracePath.empty() && !RIDEEASY_TRACING_ENABLED) {
+        std::cerr << "--chrome-trace needs a build with -DRIDEEASY_ENABLE_TRACING=ON" << std::endl;
+        return 1;
+    }
+    if (rates.empty()) {
+        for (int step = 0; step < sweepSteps; step++) {
+            rates.push_back(sweepStart);
+            sweepStart *= sweepFactor;
+        }
+    }
+    if (config.threads == 0 || config.durationSeconds <= 0.0 || rates.empty() ||
+        *std::min_element(rates.begin(), rates.end()) <= 0.0) {
+        std::cerr << "--threads, --duration and every rate must be positive" << std::endl;
+        return 1;
+    }
+
+    RideManager& rideManager = RideManager::getInstance();
+    rideManager.setRandomSeed(static_cast<std::uint32_t>(config.seed));
+    FlightRecorder& flightRecorder = FlightRecorder::instance();
+    if (!flightPrefix.empty()) {
+        try {
+            flightRecorder.start();
+            flightRecorder.setAnomalyDump(flightPrefix + "-anomaly");
+#if defined(__unix__) || defined(__APPLE__)
+            flightRecorder.installCrashHandler(flightPrefix + "-crash.bin");
+#endif
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        rideManager.setSlowRequestThresholdUs(flightSlowUs);
+    }
+    LoadGenerator generator(rideManager);
+    generator.setupFleet(drivers, riders, config.seed);
+    std::unique_ptr<MetricsHttpServer> metricsServer;
+    if (metricsPort >= 0) {
+        try {
+            metricsServer = std::make_unique<MetricsHttpServer>(rideManager.getMetrics(),
+                                                                static_cast<std::uint16_t>(metricsPort));
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Metrics: http://127.0.0.1:" << metricsServer->getPort() << "/metrics" << std::endl;
+    }
+
+    std::cout << "[LOADGEN] threads=" << config.threads << " duration=" << config.durationSeconds
+              << "s drivers=" << drivers << " location-share=" << config.locationShare << " slo(p99 ride)="
+              << sloUs << "us" << std::endl;
+    std::cout << std::setw(12) << "target/s" << std::setw(12) << "achieved/s" << std::setw(11) << "ride p50"
+              << std::setw(11) << "ride p99" << std::setw(11) << "ride p999" << std::setw(13) << "ride p99 svc"
+              << std::setw(11) << "loc p99" << std::setw(11) << "behind ms" << std::setw(8) << "late %"
+              << "   (latencies in us)" << std::endl;
+    std::cout << std::fixed;
+
+    // Unrecorded warm-up at the first rate (allocations, caches, branch history)
+    LoadConfig warmup = config;
+    warmup.ratePerSecond = rates.front();
+    warmup.durationSeconds = std::min(1.0, config.durationSeconds);
+    try {
+        generator.run(warmup);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    rideManager.resetLatencyStats();
+    TraceCollector::instance().clear();
+
+    double knee = 0.0;
+    int failuresInARow = 0;
+    for (double rate : rates) {
+        config.ratePerSecond = rate;
+        LoadResult result;
+        try {
+            result = generator.run(config);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        auto& ride = result.corrected[static_cast<int>(LoadOperation::RIDE)];
+        auto& rideService = result.service[static_cast<int>(LoadOperation::RIDE)];
+        auto& location = result.corrected[static_cast<int>(LoadOperation::LOCATION_UPDATE)];
+        double rideP99Us = ride.percentile(99.0) / 1000.0;
+
+        std::cout << std::setprecision(0) << std::setw(12) << rate << std::setw(12) << result.achievedRate
+                  << std::setprecision(1) << std::setw(11) << ride.percentile(50.0) / 1000.0 << std::setw(11)
+                  << rideP99Us << std::setw(11) << ride.percentile(99.9) / 1000.0 << std::setw(13)
+                  << rideService.percentile(99.0) / 1000.0 << std::setw(11) << location.percentile(99.0) / 1000.0
+                  << std::setw(11) << result.maxBehindMs << std::setw(8)
+                  << (result.issued > 0 ? 100.0 * result.late / result.issued : 0.0) << std::endl;
+
+        // Sustained: keeps up with the schedule (completes it inside the window with
+        // few late starts) and meets the latency objective
+        double lateShare = result.issued > 0 ? static_cast<double>(result.late) / result.issued : 0.0;
+        bool sustained = result.achievedRate >= 0.95 * rate && lateShare <= 0.05 && rideP99Us <= sloUs;
+        if (sustained) {
+            knee = rate;
+            failuresInARow = 0;
+        } else if (++failuresInARow == 2) {
+            break; // past the knee; higher rates only queue longer
+        }
+    }
+
+    if (knee > 0.0) {
+        std::cout << "Knee: " << std::setprecision(0) << knee << " ops/s is the highest rate sustained within the SLO"
+                  << std::endl;
+    } else {
+        std::cout << "Knee: no tested rate was sustained within the SLO" << std::endl;
+    }
+
+    std::cout << "Engine stages (service time inside RideManager, us):" << std::endl;
+    std::cout << "  " << std::left << std::setw(18) << "stage" << std::right << std::setw(10) << "count"
+              << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10)
+              << "p999" << std::setw(10) << "max" << std::endl;
+    for (EngineOperation stage : {EngineOperation::REQUEST_RIDE, EngineOperation::MATCHING, EngineOperation::PRICING,
+                                  EngineOperation::NOTIFICATION, EngineOperation::UPDATE_RIDE_STATUS}) {
+        LatencySummary summary = rideManager.getLatencySummary(stage);
+        std::cout << "  " << std::left << std::setw(18) << RideManager::getOperationName(stage) << std::right
+                  << std::setw(10) << summary.count << std::setprecision(2) << std::setw(10) << summary.meanNs / 1000.0
+                  << std::setw(10) << summary.p50Ns / 1000.0 << std::setw(10) << summary.p99Ns / 1000.0
+                  << std::setw(10) << summary.p999Ns / 1000.0 << std::setw(10) << summary.maxNs / 1000.0 << std::endl;
+    }
+
+    if (!metricsPath.empty()) {
+        try {
+            rideManager.getMetrics().writeToFile(metricsPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Metrics: " << metricsPath << std::endl;
+    }
+
+    if (!flightPrefix.empty()) {
+        try {
+            flightRecorder.dump(flightPrefix + ".bin");
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Flight recording: " << flightPrefix << ".bin (decode with rideeasy_flight_dump)" << std::endl;
+        if (flightRecorder.getDroppedThreads() > 0) {
+            std::cout << "[WARN] " << flightRecorder.getDroppedThreads()
+                      << " threads found no free flight recorder ring and recorded nothing" << std::endl;
+        }
+    }
+
+    if (!chromeTracePath.empty()) {
+        try {
+            TraceCollector::instance().saveChromeJson(chromeTracePath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        std::cout << "Chrome trace: " << chromeTracePath << " (" << TraceCollector::instance().getDroppedCount()
+                  << " older spans overwritten in the per-thread rings)" << std::endl;
+    }
+    return 0;
+}
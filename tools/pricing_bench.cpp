@@ -0,0 +1,109 @@
+// RideEasy pricing benchmark: fares/second for random decorator stacks,
+// comparing the reference decorator chain with the compiled pricing engine.
+
+#include "PricingFuzz.h"
+#include "CompiledPricing.h"
+#include "PricingStrategy.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_pricing_bench [--stacks N] [--fares N] [--depth N] [--seed N]\n";
+
+struct BenchResult {
+    double seconds = 0.0;
+    double checksum = 0.0;
+    std::size_t fares = 0;
+
+    double faresPerSecond() const { return seconds > 0 ? fares / seconds : 0.0; }
+};
+
+template <typename Fn>
+double timeSeconds(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    int stackCount = 64;
+    std::size_t faresPerStack = 200000;
+    int maxDepth = 4;
+    unsigned long long seed = 42;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--stacks") stackCount = std::atoi(argv[i + 1]);
+        else if (arg == "--fares") faresPerStack = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--depth") maxDepth = std::atoi(argv[i + 1]);
+        else if (arg == "--seed") seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    PricingFuzz fuzz(seed);
+    std::vector<double> distances(faresPerStack);
+    std::vector<VehicleType> vehicleTypes(faresPerStack);
+    std::vector<double> fares(faresPerStack);
+
+    BenchResult reference, compiled, batched;
+
+    for (int s = 0; s < stackCount; s++) {
+        PricingPlan plan = fuzz.randomPlan(maxDepth);
+        fuzz.fillInputs(distances, vehicleTypes);
+
+        auto chain = plan.buildDecoratorChain();
+        reference.seconds += timeSeconds([&]() {
+            for (std::size_t i = 0; i < faresPerStack; i++) {
+                reference.checksum += chain->calculateFare(distances[i], vehicleTypes[i]);
+            }
+        });
+
+        CompiledPricingCalculator engine(plan);
+        PricingCalculator& engineAsInterface = engine;
+        compiled.seconds += timeSeconds([&]() {
+            for (std::size_t i = 0; i < faresPerStack; i++) {
+                compiled.checksum += engineAsInterface.calculateFare(distances[i], vehicleTypes[i]);
+            }
+        });
+
+        batched.seconds += timeSeconds([&]() {
+            engine.calculateFares(distances.data(), vehicleTypes.data(), fares.data(), faresPerStack);
+        });
+        for (double fare : fares) {
+            batched.checksum += fare;
+        }
+
+        reference.fares += faresPerStack;
+        compiled.fares += faresPerStack;
+        batched.fares += faresPerStack;
+    }
+
+    std::cout << "[PRICING BENCH] stacks=" << stackCount << " faresPerStack=" << faresPerStack
+              << " maxDepth=" << maxDepth << " seed=" << seed << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  reference decorators : " << reference.faresPerSecond() << " fares/s" << std::endl;
+    std::cout << "  compiled (virtual)   : " << compiled.faresPerSecond() << " fares/s" << std::endl;
+    std::cout << "  compiled (batch)     : " << batched.faresPerSecond() << " fares/s" << std::endl;
+    std::cout << std::setprecision(6);
+    std::cout << "  checksums            : " << reference.checksum << " / " << compiled.checksum
+              << " / " << batched.checksum << std::endl;
+
+    if (reference.checksum != compiled.checksum || reference.checksum != batched.checksum) {
+        std::cerr << "[ERROR] Engines disagree - run rideeasy_pricing_diff" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+// RideEasy pricing differential checker: runs the reference decorator chain and
+// every candidate pricing engine over random stacks and inputs, and requires
+// bit-identical fares (or the same exception) for every case.
+//
+// To check a new engine, add it to the candidate list in main().
+
+#include "PricingFuzz.h"
+#include "CompiledPricing.h"
+#include "PricingStrategy.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_pricing_diff [--cases N] [--depth N] [--seed N]\n";
+
+struct PricingEngineCandidate {
+    std::string name;
+    std::function<std::unique_ptr<PricingCalculator>(const PricingPlan&)> build;
+    std::size_t mismatches = 0;
+};
+
+struct FareOutcome {
+    bool threw = false;
+    double fare = 0.0;
+};
+
+FareOutcome priceOnce(PricingCalculator& calculator, double distance, VehicleType vehicleType) {
+    FareOutcome outcome;
+    try {
+        outcome.fare = calculator.calculateFare(distance, vehicleType);
+    } catch (const std::invalid_argument&) {
+        outcome.threw = true;
+    }
+    return outcome;
+}
+
+std::string describeOutcome(const FareOutcome& outcome) {
+    if (outcome.threw) {
+        return "throw";
+    }
+    std::ostringstream text;
+    text << std::setprecision(17) << outcome.fare;
+    return text.str();
+}
+
+bool sameOutcome(const FareOutcome& a, const FareOutcome& b) {
+    if (a.threw || b.threw) {
+        return a.threw == b.threw;
+    }
+    return std::memcmp(&a.fare, &b.fare, sizeof(double)) == 0;
+}
+
+std::string describePlan(const PricingPlan& plan) {
+    std::string text = "Base";
+    for (const auto& step : plan.getSteps()) {
+        switch (step.kind) {
+            case PricingStepKind::SURGE: text += " -> Surge(" + std::to_string(step.value) + ")"; break;
+            case PricingStepKind::DISCOUNT: text += " -> Discount(" + std::to_string(step.value) + ")"; break;
+            case PricingStepKind::TOLL: text += " -> Toll(" + std::to_string(step.value) + ")"; break;
+        }
+    }
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    std::size_t caseCount = 5000000;
+    int maxDepth = 6;
+    unsigned long long seed = 1;
+    const std::size_t casesPerStack = 64;
+    const std::size_t maxReported = 10;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--cases") caseCount = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--depth") maxDepth = std::atoi(argv[i + 1]);
+        else if (arg == "--seed") seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<PricingEngineCandidate> candidates;
+    candidates.push_back({"CompiledPricingCalculator",
+                          [](const PricingPlan& plan) -> std::unique_ptr<PricingCalculator> {
+                              return std::make_unique<CompiledPricingCalculator>(plan);
+                          }});
+
+    PricingFuzz fuzz(seed);
+    std::size_t checked = 0;
+    std::size_t reported = 0;
+
+    while (checked < caseCount) {
+        PricingPlan plan = fuzz.randomPlan(maxDepth);
+        auto reference = plan.buildDecoratorChain();
+
+        std::vector<std::unique_ptr<PricingCalculator>> engines;
+        for (const auto& candidate : candidates) {
+            engines.push_back(candidate.build(plan));
+        }
+
+        for (std::size_t c = 0; c < casesPerStack && checked < caseCount; c++, checked++) {
+            double distance = fuzz.randomDistance();
+            VehicleType vehicleType = fuzz.randomVehicleType();
+            FareOutcome expected = priceOnce(*reference, distance, vehicleType);
+
+            for (std::size_t e = 0; e < engines.size(); e++) {
+                FareOutcome actual = priceOnce(*engines[e], distance, vehicleType);
+                if (sameOutcome(expected, actual)) {
+                    continue;
+                }
+                candidates[e].mismatches++;
+                if (reported++ < maxReported) {
+                    std::cout << std::setprecision(17)
+                              << "[MISMATCH] " << candidates[e].name << ": " << describePlan(plan)
+                              << " distance=" << distance
+                              << " vehicle=" << VehicleTypeFactory::getVehicleTypeName(vehicleType)
+                              << " expected=" << describeOutcome(expected)
+                              << " actual=" << describeOutcome(actual)
+                              << std::endl;
+                }
+            }
+        }
+    }
+
+    bool passed = true;
+    std::cout << "[PRICING DIFF] cases=" << checked << " maxDepth=" << maxDepth << " seed=" << seed << std::endl;
+    for (const auto& candidate : candidates) {
+        std::cout << "  " << candidate.name << ": "
+                  << (candidate.mismatches == 0 ? "OK" : std::to_string(candidate.mismatches) + " mismatches")
+                  << std::endl;
+        passed = passed && candidate.mismatches == 0;
+    }
+    return passed ? 0 : 1;
+}
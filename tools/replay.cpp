@@ -0,0 +1,94 @@
+// RideEasy trace replay: drives the engine with a recorded stream of API calls
+// (from rideeasy_sim --record or hand-written CSV) and reports throughput and
+// per-operation latency percentiles.
+
+#include "TraceReplayer.h"
+#include "Trace.h"
+#include "RideManager.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_replay --trace FILE [--speed 1|N|max] [--seed N]\n";
+
+int main(int argc, char* argv[]) {
+    std::string tracePath;
+    std::string speedText = "max";
+    unsigned long seed = 42;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--trace") tracePath = argv[i + 1];
+        else if (arg == "--speed") speedText = argv[i + 1];
+        else if (arg == "--seed") seed = std::strtoul(argv[i + 1], nullptr, 10);
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (tracePath.empty()) {
+        std::cerr << USAGE;
+        return 1;
+    }
+    if (speedText != "max" && !speedText.empty() && (speedText.back() == 'x' || speedText.back() == 'X')) {
+        speedText.pop_back();
+    }
+    double speed = speedText == "max" ? 0.0 : std::atof(speedText.c_str());
+    if (speedText != "max" && speed <= 0.0) {
+        std::cerr << "--speed must be positive or 'max'" << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceRecord> records;
+    try {
+        records = TraceFile::load(tracePath);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    RideManager& rideManager = RideManager::getInstance();
+    rideManager.setRandomSeed(static_cast<std::uint32_t>(seed));
+    TraceReplayer replayer(rideManager);
+    ReplayReport report = replayer.replay(records, speed);
+
+    static const char* const operationNames[] = {"registerRider", "registerDriver", "updateDriverLocation",
+                                                 "requestRide", "updateRideStatus"};
+    std::cout << "[REPLAY] trace=" << tracePath << " records=" << records.size()
+              << " speed=" << (speed > 0.0 ? speedText + "x" : std::string("max")) << std::endl;
+    std::cout << "  " << std::left << std::setw(22) << "operation" << std::right << std::setw(10) << "calls"
+              << std::setw(8) << "errors" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "p999 us" << std::setw(10) << "max us" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int op = 0; op < 5; op++) {
+        OperationStats& stats = report.operations[op];
+        if (stats.latenciesNs.empty()) {
+            continue;
+        }
+        std::cout << "  " << std::left << std::setw(22) << operationNames[op] << std::right << std::setw(10)
+                  << stats.latenciesNs.size() << std::setw(8) << stats.errors;
+        for (double p : {50.0, 90.0, 99.0, 99.9, 100.0}) {
+            std::cout << std::setw(10) << stats.percentile(p) / 1000.0;
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "  throughput : " << std::setprecision(0) << report.records / report.wallSeconds << " calls/s"
+              << std::setprecision(2) << " (" << report.wallSeconds << " s wall, " << report.traceSeconds
+              << " s of trace)" << std::endl;
+    if (speed > 0.0) {
+        std::cout << "  max lag    : " << report.maxLagNs / 1e6 << " ms behind schedule" << std::endl;
+    }
+    if (report.unknownRides > 0) {
+        std::cout << "  skipped    : " << report.unknownRides << " status updates for rides that failed to request"
+                  << std::endl;
+    }
+    return 0;
+}
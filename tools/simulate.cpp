@@ -0,0 +1,147 @@
+// RideEasy city simulator: drives the engine through a day of synthetic demand
+// on a virtual clock and reports ride KPIs, simulation speed and the match
+// cost/quality per vehicle type and pickup zone. Demand is uniform over the
+// city unless a file from rideeasy_workload_gen is given.
+
+#include "CitySimulator.h"
+#include "Workload.h"
+#include "Trace.h"
+#include "RideManager.h"
+#include "Tracing.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_sim [--drivers N] [--rides N] [--hours H] [--seed N]\n"
+    "                    [--gps-interval MS] [--speed KMH] [--workload FILE]\n"
+    "                    [--record TRACE]   (engine calls as a .bin or CSV trace)\n"
+    "                    [--chrome-trace FILE]  (engine spans; needs RIDEEASY_ENABLE_TRACING)\n";
+
+int main(int argc, char* argv[]) {
+    std::size_t driverCount = 5000; // keeps up with the default demand (about 99% of rides served)
+    std::size_t rideCount = 100000;
+    double hours = 24.0;
+    SimulationConfig config;
+    std::string workloadPath;
+    std::string tracePath;
+    std::string chromeTracePath;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--drivers") driverCount = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--rides") rideCount = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--hours") hours = std::atof(argv[i + 1]);
+        else if (arg == "--seed") config.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--gps-interval") config.gpsIntervalMs = std::atoll(argv[i + 1]);
+        else if (arg == "--speed") config.speedKmh = std::atof(argv[i + 1]);
+        else if (arg == "--workload") workloadPath = argv[i + 1];
+        else if (arg == "--record") tracePath = argv[i + 1];
+        else if (arg == "--chrome-trace") chromeTracePath = argv[i + 1];
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (hours <= 0.0 || config.speedKmh <= 0.0) {
+        std::cerr << "--hours and --speed must be positive" << std::endl;
+        return 1;
+    }
+    if (!chromeTracePath.empty() && !RIDEEASY_TRACING_ENABLED) {
+        std::cerr << "--chrome-trace needs a build with -DRIDEEASY_ENABLE_TRACING=ON" << std::endl;
+        return 1;
+    }
+
+    RideManager& rideManager = RideManager::getInstance();
+    CitySimulator simulator(rideManager, config);
+    std::vector<TraceRecord> trace;
+    if (!tracePath.empty()) {
+        simulator.recordTo(&trace);
+    }
+    if (workloadPath.empty()) {
+        CitySimulator::populateUniform(simulator, driverCount, rideCount, hours, config.seed);
+    } else {
+        try {
+            Workload workload = WorkloadFile::load(workloadPath);
+            simulator.addWorkload(workload);
+            driverCount = workload.drivers.size();
+            rideCount = workload.requests.size();
+            hours = workload.durationMs / 3600000.0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    // Match telemetry window covering the demand period (slices align to the clock, hence the spare one)
+    std::int64_t sliceMs = static_cast<std::int64_t>(hours * 3600000.0 / 24.0) + 1;
+    std::int64_t demandEndMs = config.startTimeMs + static_cast<std::int64_t>(hours * 3600000.0);
+    rideManager.setMatchTelemetryWindow(sliceMs * 25, 25);
+    SimulationReport report = simulator.run();
+    if (!tracePath.empty()) {
+        try {
+            TraceFile::save(trace, tracePath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    if (!chromeTracePath.empty()) {
+        try {
+            TraceCollector::instance().saveChromeJson(chromeTracePath);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::size_t served = report.ridesAssigned > 0 ? report.ridesAssigned : 1;
+    std::cout << "[SIMULATION] drivers=" << driverCount << " rides=" << rideCount << " hours=" << hours
+              << " seed=" << config.seed << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  requested / assigned : " << report.ridesRequested << " / " << report.ridesAssigned << std::endl;
+    std::cout << "  completed            : " << report.ridesCompleted << std::endl;
+    std::cout << "  unserved / rejected  : " << report.ridesUnserved << " / " << report.ridesRejected << std::endl;
+    std::cout << "  mean pickup distance : " << report.totalPickupKm / served << " km" << std::endl;
+    std::cout << "  mean pickup wait     : " << report.totalWaitSeconds / served << " s" << std::endl;
+    std::cout << "  total fares          : Rs." << report.totalFare << std::endl;
+    std::cout << "  location updates     : " << report.locationUpdates << std::endl;
+    std::cout << "  simulated time       : " << report.simulatedSeconds / 3600.0 << " h" << std::endl;
+    if (!tracePath.empty()) {
+        std::cout << "  trace records        : " << trace.size() << " -> " << tracePath << std::endl;
+    }
+    if (!chromeTracePath.empty()) {
+        std::cout << "  chrome trace         : " << chromeTracePath << " ("
+                  << TraceCollector::instance().getDroppedCount() << " older spans overwritten in the per-thread rings)"
+                  << std::endl;
+    }
+    std::cout << "  wall time            : " << report.wallSeconds << " s ("
+              << std::setprecision(0) << report.events / report.wallSeconds << " events/s)" << std::endl;
+
+    std::vector<MatchSummary> matches = rideManager.getMatchSummaries(demandEndMs);
+    std::cout << "  matching by vehicle/zone (busiest " << std::min<std::size_t>(matches.size(), 10) << " of "
+              << matches.size() << "):" << std::endl;
+    std::cout << "    " << std::left << std::setw(22) << "vehicle/zone" << std::right << std::setw(9) << "requests"
+              << std::setw(10) << "assigned" << std::setw(10) << "scanned" << std::setw(9) << "probed" << std::setw(12)
+              << "candidates" << std::setw(10) << "attempts" << std::setw(11) << "pickup km" << std::setw(10)
+              << "mean us" << std::setw(10) << "max us" << std::endl;
+    for (std::size_t i = 0; i < matches.size() && i < 10; i++) {
+        const MatchSummary& match = matches[i];
+        std::string zone = match.zone == GeofenceEngine::NO_ZONE ? "-" : rideManager.getZoneName(match.zone);
+        std::cout << "    " << std::left << std::setw(22)
+                  << VehicleTypeFactory::getVehicleTypeName(match.vehicleType) + "/" + zone << std::right
+                  << std::setw(9) << match.requests << std::setprecision(1) << std::setw(9)
+                  << match.assignRate() * 100.0 << "%" << std::setprecision(0) << std::setw(10)
+                  << match.meanSlotsScanned << std::setprecision(1) << std::setw(9) << match.meanBucketsProbed
+                  << std::setprecision(0) << std::setw(12) << match.meanCandidates << std::setprecision(2)
+                  << std::setw(10) << match.meanAttempts << std::setw(11) << match.meanPickupKm << std::setprecision(1)
+                  << std::setw(10) << match.meanDurationUs << std::setw(10) << match.maxDurationUs << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+// RideEasy parameter sweep: runs the city simulation for every combination of
+// matching strategy and pricing setting over several seeded workloads, one
+// engine per run, spread across all cores, and compares the KPIs.
+
+#include "CitySimulator.h"
+#include "WorkloadGenerator.h"
+#include "WorkStealingPool.h"
+#include "RideManager.h"
+#include "MatchingStrategy.h"
+#include "CompiledPricing.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <stdexcept>
+#include <cmath>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_sweep [--strategies nearest,bestrated] [--surge 1.0,1.5]\n"
+    "                      [--discount 0,10] [--replicas N] [--seed N]\n"
+    "                      [--drivers N] [--rides-per-day N] [--hours H]\n"
+    "                      [--threads N] [--csv FILE]\n";
+
+struct SweepConfig {
+    std::string strategy;
+    double surge;
+    double discount;
+};
+
+struct SweepRun {
+    std::size_t config;  // index into the configurations
+    std::size_t replica; // index into the workloads
+    SimulationReport report;
+    std::string error;
+};
+
+// KPIs of one run, in the order they are printed
+static std::vector<double> kpis(const SimulationReport& report) {
+    double served = report.ridesAssigned > 0 ? static_cast<double>(report.ridesAssigned) : 1.0;
+    double requested = report.ridesRequested > 0 ? static_cast<double>(report.ridesRequested) : 1.0;
+    return {report.ridesAssigned * 100.0 / requested,
+            report.totalWaitSeconds / served,
+            report.totalPickupKm / served,
+            report.utilization() * 100.0,
+            report.totalFare,
+            report.cpuSeconds * 1e6 / requested};
+}
+
+static const char* const KPI_NAMES[] = {"served %", "wait s", "pickup km", "util %", "revenue Rs", "cpu us/ride"};
+
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> values;
+    std::istringstream list(text);
+    std::string value;
+    while (std::getline(list, value, ',')) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+static std::unique_ptr<MatchingStrategy> makeStrategy(const std::string& name) {
+    if (name == "nearest") return std::make_unique<NearestDriverStrategy>();
+    if (name == "bestrated") return std::make_unique<BestRatedDriverStrategy>();
+    throw std::invalid_argument("Unknown strategy: " + name + " (expected nearest or bestrated)");
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> strategies = {"nearest", "bestrated"};
+    std::vector<std::string> surges = {"1.0", "1.5"};
+    std::vector<std::string> discounts = {"0"};
+    std::size_t replicas = 4;
+    std::size_t threads = std::thread::hardware_concurrency();
+    std::string csvPath;
+    WorkloadSpec spec = WorkloadSpec::mumbai();
+    spec.drivers = 1000;
+    spec.ridesPerDay = 20000;
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--strategies") strategies = splitList(argv[i + 1]);
+        else if (arg == "--surge") surges = splitList(argv[i + 1]);
+        else if (arg == "--discount") discounts = splitList(argv[i + 1]);
+        else if (arg == "--replicas") replicas = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--seed") spec.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--drivers") spec.drivers = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--rides-per-day") spec.ridesPerDay = std::atof(argv[i + 1]);
+        else if (arg == "--hours") spec.durationHours = std::atof(argv[i + 1]);
+        else if (arg == "--threads") threads = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--csv") csvPath = argv[i + 1];
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (replicas == 0) {
+        std::cerr << "--replicas must be at least 1" << std::endl;
+        return 1;
+    }
+
+    std::vector<SweepConfig> configs;
+    std::vector<Workload> workloads;
+    try {
+        for (const auto& strategy : strategies) {
+            makeStrategy(strategy); // validates the name up front
+            for (const auto& surge : surges) {
+                for (const auto& discount : discounts) {
+                    SweepConfig config{strategy, std::stod(surge), std::stod(discount)};
+                    CompiledPricingCalculator validate(PricingPlan().surge(config.surge).discount(config.discount));
+                    configs.push_back(config);
+                }
+            }
+        }
+        // Replica r uses seed + r for both its workload and its engine, so every
+        // configuration sees exactly the same demand
+        for (std::size_t r = 0; r < replicas; r++) {
+            WorkloadSpec replicaSpec = spec;
+            replicaSpec.seed = spec.seed + r;
+            workloads.push_back(WorkloadGenerator(replicaSpec).generate());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<SweepRun> runs;
+    for (std::size_t c = 0; c < configs.size(); c++) {
+        for (std::size_t r = 0; r < replicas; r++) {
+            runs.push_back({c, r, SimulationReport(), ""});
+        }
+    }
+
+    std::vector<std::function<void()>> tasks;
+    for (auto& run : runs) {
+        tasks.push_back([&run, &configs, &workloads, &spec]() {
+            try {
+                const SweepConfig& config = configs[run.config];
+                RideManager engine;
+                engine.setMatchingStrategy(makeStrategy(config.strategy));
+                engine.setPricingCalculator(std::make_unique<CompiledPricingCalculator>(
+                    PricingPlan().surge(config.surge).discount(config.discount)));
+                SimulationConfig simulation;
+                simulation.seed = spec.seed + run.replica;
+                CitySimulator simulator(engine, simulation);
+                simulator.addWorkload(workloads[run.replica]);
+                run.report = simulator.run();
+            } catch (const std::exception& e) {
+                run.error = e.what();
+            }
+        });
+    }
+
+    WorkStealingPool pool(threads);
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<std::size_t> steals = pool.run(std::move(tasks));
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    double cpuSeconds = 0.0;
+    std::size_t stolen = 0;
+    for (const auto& run : runs) {
+        if (!run.error.empty()) {
+            std::cerr << "Run " << configs[run.config].strategy << " replica " << run.replica
+                      << " failed: " << run.error << std::endl;
+            return 1;
+        }
+        cpuSeconds += run.report.cpuSeconds;
+    }
+    for (std::size_t count : steals) {
+        stolen += count;
+    }
+
+    std::cout << "[SWEEP] configs=" << configs.size() << " replicas=" << replicas << " runs=" << runs.size()
+              << " threads=" << pool.getThreadCount() << " drivers=" << spec.drivers
+              << " rides/day=" << spec.ridesPerDay << std::endl;
+    std::cout << "  " << std::left << std::setw(24) << "strategy/surge/discount" << std::right;
+    for (const char* name : KPI_NAMES) {
+        std::cout << std::setw(20) << name;
+    }
+    std::cout << "\n  (mean +- stddev over replicas)" << std::endl;
+
+    std::cout << std::fixed;
+    for (std::size_t c = 0; c < configs.size(); c++) {
+        std::vector<std::vector<double>> values;
+        for (const auto& run : runs) {
+            if (run.config == c) {
+                values.push_back(kpis(run.report));
+            }
+        }
+        std::ostringstream label;
+        label << std::fixed << configs[c].strategy << "/" << std::setprecision(2) << configs[c].surge << "/"
+              << std::setprecision(0) << configs[c].discount << "%";
+        std::cout << "  " << std::left << std::setw(24) << label.str() << std::right;
+        for (std::size_t k = 0; k < values.front().size(); k++) {
+            double mean = 0.0;
+            for (const auto& v : values) mean += v[k];
+            mean /= values.size();
+            double variance = 0.0;
+            for (const auto& v : values) variance += (v[k] - mean) * (v[k] - mean);
+            double stddev = values.size() > 1 ? std::sqrt(variance / (values.size() - 1)) : 0.0;
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(k == 4 ? 0 : 2) << mean << " +-" << stddev;
+            std::cout << std::setw(20) << cell.str();
+        }
+        std::cout << std::endl;
+    }
+    std::cout << std::setprecision(2) << "  wall " << wallSeconds << " s, simulation CPU " << cpuSeconds << " s ("
+              << cpuSeconds / wallSeconds << "x parallel), " << stolen << " runs stolen" << std::endl;
+
+    if (!csvPath.empty()) {
+        std::ofstream csv(csvPath);
+        if (!csv) {
+            std::cerr << "Cannot write " << csvPath << std::endl;
+            return 1;
+        }
+        csv << "strategy,surge,discount,seed,requested,assigned,served_pct,wait_s,pickup_km,utilization_pct,"
+               "revenue,cpu_us_per_ride\n";
+        csv << std::fixed << std::setprecision(4);
+        for (const auto& run : runs) {
+            const SweepConfig& config = configs[run.config];
+            csv << config.strategy << ',' << config.surge << ',' << config.discount << ',' << spec.seed + run.replica
+                << ',' << run.report.ridesRequested << ',' << run.report.ridesAssigned;
+            for (double value : kpis(run.report)) {
+                csv << ',' << value;
+            }
+            csv << '\n';
+        }
+    }
+    return 0;
+}
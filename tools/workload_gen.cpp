@@ -0,0 +1,75 @@
+// RideEasy workload generator: writes a synthetic fleet and a day of demand
+// for Mumbai (hotspots, time-of-day curve, vehicle mix) as a compact binary
+// workload file for rideeasy_sim and the benchmarks.
+
+#include "WorkloadGenerator.h"
+#include "Workload.h"
+#include "CommandLine.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+
+static const char* const USAGE =
+    "Usage: rideeasy_workload_gen [--out FILE] [--drivers N] [--rides-per-day N]\n"
+    "                             [--hours H] [--riders N] [--carpool-share F]\n"
+    "                             [--hotspot-share F] [--seed N]\n";
+
+int main(int argc, char* argv[]) {
+    WorkloadSpec spec = WorkloadSpec::mumbai();
+    std::string outputPath = "workload.bin";
+
+    int exitCode = checkCommandLine(argc, argv, USAGE);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    for (int i = 1; i < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--out") outputPath = argv[i + 1];
+        else if (arg == "--drivers") spec.drivers = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--rides-per-day") spec.ridesPerDay = std::atof(argv[i + 1]);
+        else if (arg == "--hours") spec.durationHours = std::atof(argv[i + 1]);
+        else if (arg == "--riders") spec.riders = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--carpool-share") spec.carpoolShare = std::atof(argv[i + 1]);
+        else if (arg == "--hotspot-share") spec.hotspotShare = std::atof(argv[i + 1]);
+        else if (arg == "--seed") spec.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        Workload workload = WorkloadGenerator(spec).generate();
+        std::size_t bytes = WorkloadFile::save(workload, outputPath);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t perHour[24] = {};
+        std::size_t carpools = 0;
+        for (const auto& request : workload.requests) {
+            perHour[(request.offsetMs / 3600000) % 24]++;
+            carpools += request.rideType == RideType::CARPOOL;
+        }
+
+        std::cout << "[WORKLOAD] " << outputPath << " seed=" << spec.seed << std::endl;
+        std::cout << "  drivers / riders : " << workload.drivers.size() << " / " << workload.riderCount << std::endl;
+        std::cout << "  requests         : " << workload.requests.size() << " (" << carpools << " carpool)"
+                  << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  file size        : " << bytes / 1024.0 << " KiB ("
+                  << (workload.requests.empty() ? 0.0 : static_cast<double>(bytes) / workload.requests.size())
+                  << " B/request)" << std::endl;
+        std::cout << "  generated in     : " << seconds << " s" << std::endl;
+        std::cout << "  requests by hour :";
+        for (int hour = 0; hour < 24; hour++) {
+            std::cout << (hour % 8 == 0 ? "\n    " : " ") << std::setw(2) << hour << "h=" << perHour[hour];
+        }
+        std::cout << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}